@@ -0,0 +1,181 @@
+/**
+ * Measures what typical drawing workloads cost on each bus, with the bus models of the host mocks.
+ * For each bus, clock and workload, prints the simulated time of a frame, and the bytes and transactions it took on the bus, averaged over a few frames.
+ */
+
+/* C/C++ libraries */
+#include <stdio.h>
+
+/* Arduino libraries */
+#include <Arduino.h>
+#include <SPI.h>
+#include <Wire.h>
+
+/* Project libraries */
+#include "sh1106.h"
+#include "sh1106_emulator.h"
+
+/* Pins of the panel */
+#define PIN_RES 8
+#define PIN_DC 9
+#define PIN_CS 10
+
+/* Frames measured for each workload, after a first one that is not counted */
+#define FRAMES 8
+
+enum bus {
+    BUS_I2C_BUFFERED,
+    BUS_I2C_LIGHT,
+    BUS_SPI_4WIRES,
+#if SH1106_SPI_3WIRES_GROUPS > 0
+    BUS_SPI_3WIRES,
+#endif
+};
+
+static const struct configuration {
+    enum bus bus;
+    uint32_t frequency;
+    const char* name;
+} m_configurations[] = {
+    {BUS_I2C_BUFFERED, 100000, "i2c buffered"},
+    {BUS_I2C_BUFFERED, 400000, "i2c buffered"},
+    {BUS_I2C_BUFFERED, 1000000, "i2c buffered"},
+    {BUS_I2C_LIGHT, 100000, "i2c light"},
+    {BUS_I2C_LIGHT, 400000, "i2c light"},
+    {BUS_I2C_LIGHT, 1000000, "i2c light"},
+    {BUS_SPI_4WIRES, 1000000, "spi 4-wires"},
+    {BUS_SPI_4WIRES, SH1106_SPI_SPEED_MAX, "spi 4-wires"},
+#if SH1106_SPI_3WIRES_GROUPS > 0
+    {BUS_SPI_3WIRES, 1000000, "spi 3-wires"},
+    {BUS_SPI_3WIRES, SH1106_SPI_SPEED_MAX, "spi 3-wires"},
+#endif
+};
+
+/* Icon in page format, a 16x16 framed cross */
+static const uint8_t m_icon[32] = {
+    0xFF, 0x01, 0x05, 0x09, 0x11, 0x21, 0x41, 0x81, 0x81, 0x41, 0x21, 0x11, 0x09, 0x05, 0x01, 0xFF,
+    0xFF, 0x80, 0xA0, 0x90, 0x88, 0x84, 0x82, 0x81, 0x81, 0x82, 0x84, 0x88, 0x90, 0xA0, 0x80, 0xFF,
+};
+
+/**
+ * Draws a whole new screen of vertical bars.
+ */
+static void m_full_redraw(sh1106& panel, const int frame) {
+    panel.fillScreen(0);
+    for (int16_t x = frame % 4; x < panel.width(); x += 4) {
+        panel.fillRect(x, 0, 2, panel.height(), 1);
+    }
+    panel.display();
+}
+
+/**
+ * Rewrites a line of text, as a counter would.
+ */
+static void m_text_update(sh1106& panel, const int frame) {
+    char text[16];
+    snprintf(text, sizeof(text), "%08d", 1234567 + frame * 1111);
+    panel.setTextColor(1, 0);
+    panel.setCursor(16, 24);
+    panel.print(text);
+    panel.display();
+}
+
+/**
+ * Moves an icon along a row.
+ */
+static void m_icon_blit(sh1106& panel, const int frame) {
+    panel.bitmap_draw(frame * 12, 16, m_icon, 16, 16, sh1106::BITMAP_FORMAT_PAGES, sh1106::OPERATION_COPY);
+    panel.display();
+}
+
+/**
+ * Scrolls the screen up by a line of text, and writes a new one at the bottom, as a console would.
+ */
+static void m_scroll(sh1106& panel, const int frame) {
+    char text[24];
+    snprintf(text, sizeof(text), "line %d", frame);
+    panel.scroll_up();
+    panel.setTextColor(1, 0);
+    panel.setCursor(0, panel.height() - 8);
+    panel.print(text);
+    panel.display();
+}
+
+static const struct workload {
+    void (*run)(sh1106& panel, const int frame);
+    const char* name;
+} m_workloads[] = {
+    {m_full_redraw, "full redraw"},
+    {m_text_update, "text update"},
+    {m_icon_blit, "icon blit"},
+    {m_scroll, "scroll"},
+};
+
+/**
+ * Returns the traffic of the bus used by a configuration.
+ */
+static struct host_bus_stats m_stats_get(const struct configuration& configuration) {
+    if (configuration.bus == BUS_I2C_BUFFERED || configuration.bus == BUS_I2C_LIGHT) {
+        return Wire.stats_get();
+    }
+    return SPI.stats_get();
+}
+
+int main(void) {
+    static uint8_t buffer[128 * 8];
+
+    printf("%-14s %9s  %-12s %10s %8s %8s %13s\n", "bus", "clock", "workload", "frame (us)", "fps", "bytes", "transactions");
+    for (const struct configuration& configuration : m_configurations) {
+        for (const struct workload& workload : m_workloads) {
+
+            /* Set up a fresh panel on the bus */
+            sh1106 panel(128, 64);
+            sh1106_emulator emulator(128, 64);
+            int res = -EINVAL;
+            switch (configuration.bus) {
+                case BUS_I2C_BUFFERED:
+                case BUS_I2C_LIGHT: {
+                    Wire.setClock(configuration.frequency);
+                    Wire.device_attach(&emulator, 0x3C);
+                    if (configuration.bus == BUS_I2C_BUFFERED) {
+                        res = panel.setup(Wire, 0x3C, PIN_RES, buffer);
+                    } else {
+                        res = panel.setup(Wire, 0x3C, PIN_RES);
+                    }
+                    break;
+                }
+                case BUS_SPI_4WIRES: {
+                    SPI.device_attach(&emulator, PIN_CS, PIN_DC);
+                    res = panel.setup(SPI, configuration.frequency, PIN_CS, PIN_DC, PIN_RES, buffer);
+                    break;
+                }
+#if SH1106_SPI_3WIRES_GROUPS > 0
+                case BUS_SPI_3WIRES: {
+                    SPI.device_attach(&emulator, PIN_CS);
+                    res = panel.setup(SPI, configuration.frequency, PIN_CS, PIN_RES, buffer);
+                    break;
+                }
+#endif
+            }
+            if (res < 0) {
+                printf("%s: setup failed (%d)\n", configuration.name, res);
+                return 1;
+            }
+            panel.clear();
+            panel.display();
+            workload.run(panel, 0);
+
+            /* Measure */
+            Wire.stats_reset();
+            SPI.stats_reset();
+            const uint64_t start = host_time_get();
+            for (int frame = 1; frame <= FRAMES; frame++) {
+                workload.run(panel, frame);
+            }
+            const struct host_bus_stats stats = m_stats_get(configuration);
+            const double frame_us = (host_time_get() - start) / 1000.0 / FRAMES;
+            printf("%-14s %5u kHz  %-12s %10.0f %8.1f %8u %13u\n", configuration.name, (unsigned)(configuration.frequency / 1000), workload.name, frame_us, 1000000.0 / frame_us, stats.bytes / FRAMES, stats.transactions / FRAMES);
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,26 @@
+/* 3 frame(s) of 128x64 pixels, 356 bytes instead of 3072 */
+const uint8_t m_animation[] PROGMEM = {
+    0x80, 0x08, 0x5E, 0x01, 0x00, 0x00, 0xFF, 0x80, 0xFF, 0x42, 0x01, 0xB4, 0xD1, 0x81, 0x31, 0xE1,
+    0x91, 0x01, 0xD1, 0xA1, 0x71, 0xC1, 0x91, 0x01, 0x71, 0x21, 0x91, 0x41, 0x31, 0x01, 0xA1, 0x71,
+    0xC1, 0x91, 0x61, 0x01, 0xD1, 0x81, 0x31, 0xE1, 0x91, 0x01, 0x91, 0x21, 0x71, 0x81, 0xD1, 0x01,
+    0x71, 0x21, 0x91, 0x41, 0x31, 0x01, 0x01, 0xD1, 0xA1, 0x71, 0xC1, 0x01, 0xD1, 0xA1, 0x71, 0xC1,
+    0x91, 0x7F, 0x01, 0x45, 0x01, 0x80, 0xFF, 0x80, 0xFF, 0x42, 0x80, 0xB3, 0x81, 0x80, 0x80, 0x83,
+    0x82, 0x80, 0x87, 0x86, 0x86, 0x81, 0x80, 0x80, 0x83, 0x82, 0x85, 0x85, 0x84, 0x80, 0x85, 0x85,
+    0x84, 0x87, 0x87, 0x80, 0x81, 0x80, 0x80, 0x83, 0x82, 0x80, 0x85, 0x85, 0x84, 0x87, 0x86, 0x80,
+    0x83, 0x82, 0x85, 0x85, 0x84, 0x80, 0x81, 0x80, 0x83, 0x83, 0x82, 0x80, 0x87, 0x86, 0x86, 0x81,
+    0x7F, 0x80, 0x46, 0x80, 0x80, 0xFF, 0xC7, 0x53, 0xF0, 0xFF, 0xE3, 0xC7, 0x53, 0xFF, 0xFF, 0xD2,
+    0x82, 0xC0, 0x80, 0x40, 0xCD, 0xC7, 0x53, 0xFF, 0xFF, 0xD1, 0x84, 0x1F, 0x1D, 0x02, 0x07, 0x04,
+    0xCC, 0xFF, 0xED, 0x46, 0x80, 0x46, 0x40, 0x43, 0x20, 0xF4, 0x46, 0x80, 0x47, 0x40, 0x46, 0x20,
+    0x46, 0x10, 0x46, 0x08, 0x46, 0x04, 0x46, 0x02, 0x46, 0x01, 0xD1, 0x43, 0x80, 0x46, 0x40, 0x46,
+    0x20, 0x46, 0x10, 0x46, 0x08, 0x46, 0x04, 0x46, 0x02, 0x46, 0x01, 0xFF, 0xCA, 0xFC, 0x07, 0xDD,
+    0x53, 0x80, 0x3F, 0x05, 0x07, 0xDD, 0x53, 0xFF, 0x33, 0x84, 0x40, 0x00, 0xC0, 0x80, 0x40, 0x0C,
+    0x07, 0xDD, 0x53, 0xFF, 0x33, 0x84, 0x06, 0x0B, 0x09, 0x0E, 0x13, 0x0C, 0x25, 0x53, 0x07, 0x22,
+    0x45, 0x80, 0x45, 0x40, 0x42, 0x20, 0x01, 0xD1, 0x2C, 0x45, 0x80, 0x45, 0x40, 0x45, 0x20, 0x45,
+    0x10, 0x45, 0x08, 0x45, 0x04, 0x45, 0x02, 0x45, 0x01, 0xE2, 0x02, 0x45, 0x40, 0x45, 0x20, 0x45,
+    0x10, 0x45, 0x08, 0x45, 0x04, 0x45, 0x02, 0x45, 0x01, 0xFF, 0x12, 0xFC, 0x25, 0xFF, 0x19, 0x25,
+    0xDD, 0x53, 0xFC, 0x15, 0x84, 0x80, 0x40, 0x00, 0xC0, 0x80, 0x0C, 0x25, 0xDD, 0x53, 0xFF, 0x15,
+    0x84, 0x0D, 0x12, 0x17, 0x15, 0x1A, 0x0C, 0x25, 0xDD, 0x46, 0x3F, 0x44, 0xBF, 0x44, 0x7F, 0x42,
+    0x3F, 0x04, 0xE2, 0x24, 0x44, 0x80, 0x43, 0x40, 0x44, 0x20, 0x44, 0x10, 0x44, 0x08, 0x44, 0x04,
+    0x44, 0x02, 0x43, 0x01, 0xF4, 0x07, 0x44, 0x20, 0x43, 0x10, 0x44, 0x08, 0x44, 0x04, 0x44, 0x02,
+    0x44, 0x01, 0xFF, 0x1A,
+};
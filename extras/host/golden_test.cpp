@@ -0,0 +1,740 @@
+/**
+ * Draws scenes through each transfer path, and compares what the emulated controller ends up showing against golden images.
+ * Each scene exercises one of the optimized paths of the driver: partial updates, scrolling, the shadow buffer, strip rendering, the glyph cache, batches, triple buffering, the compositor and compressed images.
+ * Usage: sh1106_golden <path> <golden directory>, the path being one of i2c_buffered, i2c_light, spi_4wires, spi_3wires or transport.
+ *
+ * The golden images do not come from the driver: with --update as the path, they are written from a reference model that draws every scene one pixel at a time through Adafruit_GFX, with straightforward versions of the operations of the driver written from their documentation.
+ * The checked-in images were generated that way and reviewed by eye against the description of each scene before being committed, and every run also checks that the reference model still draws them, so neither side can drift silently.
+ * The compressed animation is encoded from the golden frames by the converter shipped with the library, after an update:
+ *   python3 extras/image_convert.py --name m_animation extras/host/golden/animation_*.pbm > extras/host/golden/animation.h
+ */
+
+/* C/C++ libraries */
+#include <stdio.h>
+#include <string.h>
+
+/* Arduino libraries */
+#include <Arduino.h>
+#include <SPI.h>
+#include <Wire.h>
+
+/* Project libraries */
+#include "sh1106.h"
+#include "sh1106_compositor.h"
+#include "sh1106_emulator.h"
+
+/* Compressed frames of the animation scenes */
+#include "golden/animation.h"
+
+/* Pins of the panel */
+#define PIN_RES 8
+#define PIN_DC 9
+#define PIN_CS 10
+
+/* Size of the panel */
+#define WIDTH 128
+#define HEIGHT 64
+
+/**
+ * Model of the panel the golden images are generated from.
+ * Every operation sets pixels one at a time through Adafruit_GFX, which maps rotations as documented, without any of the fast paths of the driver. The methods only used to speed up the driver do nothing.
+ */
+class reference_panel : public Adafruit_GFX {
+
+   public:
+    reference_panel(void) : Adafruit_GFX(WIDTH, HEIGHT) {}
+
+    void drawPixel(int16_t x, int16_t y, uint16_t color) {
+        bool* pixel = m_pixel_find(x, y);
+        if (pixel != NULL) {
+            *pixel = (color != 0);
+        }
+    }
+
+    bool pixel_get(const int16_t x, const int16_t y) {
+        const bool* pixel = m_pixel_find(x, y);
+        return (pixel != NULL) && *pixel;
+    }
+
+    int clear(void) {
+        memset(m_pixels, 0, sizeof(m_pixels));
+        return 0;
+    }
+
+    int display(void) {
+        return 0;
+    }
+
+    int bitmap_draw(const int16_t x, const int16_t y, const uint8_t* const bitmap, const int16_t w, const int16_t h, const enum sh1106::bitmap_format format, const enum sh1106::operation operation) {
+        if (format != sh1106::BITMAP_FORMAT_PAGES) {
+            return -EINVAL;
+        }
+        for (int16_t j = 0; j < h; j++) {
+            for (int16_t i = 0; i < w; i++) {
+                const bool bit = (bitmap[(j / 8) * w + i] >> (j % 8)) & 1;
+                switch (operation) {
+                    case sh1106::OPERATION_COPY: drawPixel(x + i, y + j, bit); break;
+                    case sh1106::OPERATION_OR: if (bit) drawPixel(x + i, y + j, 1); break;
+                    case sh1106::OPERATION_AND: if (!bit) drawPixel(x + i, y + j, 0); break;
+                    case sh1106::OPERATION_XOR: if (bit) drawPixel(x + i, y + j, !pixel_get(x + i, y + j)); break;
+                }
+            }
+        }
+        return 0;
+    }
+
+    int points_set(const struct sh1106::point* const points, const size_t count, const uint16_t color) {
+        for (size_t i = 0; i < count; i++) {
+            drawPixel(points[i].x, points[i].y, color);
+        }
+        return 0;
+    }
+
+    int spans_set(const struct sh1106::span* const spans, const size_t count, const uint16_t color) {
+        for (size_t i = 0; i < count; i++) {
+            for (int16_t j = 0; j < spans[i].w; j++) {
+                drawPixel(spans[i].x + j, spans[i].y, color);
+            }
+        }
+        return 0;
+    }
+
+    int scanlines_draw(const int16_t x, const int16_t y, const uint8_t* const bits, const int16_t w, const int16_t h, const uint16_t color) {
+        for (int16_t j = 0; j < h; j++) {
+            for (int16_t i = 0; i < w; i++) {
+                if ((bits[j * ((w + 7) / 8) + i / 8] >> (7 - (i % 8))) & 1) {
+                    drawPixel(x + i, y + j, color);
+                }
+            }
+        }
+        return 0;
+    }
+
+    int scroll_up(void) {
+        memmove(m_pixels[0], m_pixels[8], sizeof(m_pixels[0]) * (HEIGHT - 8));
+        memset(m_pixels[HEIGHT - 8], 0, sizeof(m_pixels[0]) * 8);
+        return 0;
+    }
+
+    int scroll_left(const size_t page, const size_t pages) {
+        if (pages == 0 || page + pages > HEIGHT / 8) {
+            return -EINVAL;
+        }
+        for (size_t y = page * 8; y < (page + pages) * 8; y++) {
+            memmove(&m_pixels[y][0], &m_pixels[y][1], WIDTH - 1);
+            m_pixels[y][WIDTH - 1] = false;
+        }
+        return 0;
+    }
+
+    int render(void (*callback)(reference_panel& display, void* context), void* context) {
+        callback(*this, context);
+        return 0;
+    }
+
+    int shadow_set(uint8_t* const shadow) {
+        return 0;
+    }
+
+    int glyph_cache_set(uint8_t* const cache, const size_t size) {
+        return 0;
+    }
+
+    int frames_set(uint8_t* const buffer_second, uint8_t* const buffer_third) {
+        return 0;
+    }
+
+    int frame_submit(void) {
+        return 0;
+    }
+
+    int frame_flush(void) {
+        return 0;
+    }
+
+    /**
+     * Exports the panel as a binary pbm image, lit pixels being white, in the same layout as sh1106_emulator::pbm_export().
+     */
+    size_t pbm_export(uint8_t* const pbm, const size_t size) const {
+        char header[16];
+        const size_t header_length = snprintf(header, sizeof(header), "P4\n%d %d\n", WIDTH, HEIGHT);
+        const size_t length = header_length + (WIDTH / 8) * HEIGHT;
+        if (pbm == NULL || size < length) {
+            return length;
+        }
+        memcpy(pbm, header, header_length);
+        uint8_t* row = &pbm[header_length];
+        for (int y = 0; y < HEIGHT; y++, row += WIDTH / 8) {
+            memset(row, 0, WIDTH / 8);
+            for (int x = 0; x < WIDTH; x++) {
+                if (!m_pixels[y][x]) {
+                    row[x / 8] |= 0x80 >> (x % 8);  // In pbm, 1 is black
+                }
+            }
+        }
+        return length;
+    }
+
+   protected:
+    bool m_pixels[HEIGHT][WIDTH] = {};  //!< Pixels in panel orientation.
+
+    /**
+     * Finds a pixel from its coordinates in the current rotation.
+     * @return A pointer to the pixel, or NULL if it is off the screen.
+     */
+    bool* m_pixel_find(const int16_t x, const int16_t y) {
+        if (x < 0 || y < 0 || x >= _width || y >= _height) {
+            return NULL;
+        }
+        switch (rotation) {
+            case 1: return &m_pixels[x][WIDTH - 1 - y];
+            case 2: return &m_pixels[HEIGHT - 1 - y][WIDTH - 1 - x];
+            case 3: return &m_pixels[HEIGHT - 1 - x][y];
+            default: return &m_pixels[y][x];
+        }
+    }
+};
+
+/* Icon in page format, a 16x16 framed cross */
+static const uint8_t m_icon[32] = {
+    0xFF, 0x01, 0x05, 0x09, 0x11, 0x21, 0x41, 0x81, 0x81, 0x41, 0x21, 0x11, 0x09, 0x05, 0x01, 0xFF,
+    0xFF, 0x80, 0xA0, 0x90, 0x88, 0x84, 0x82, 0x81, 0x81, 0x82, 0x84, 0x88, 0x90, 0xA0, 0x80, 0xFF,
+};
+
+/* Mask in page format covering the whole icon */
+static const uint8_t m_icon_mask[32] = {
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+};
+
+/* Solid 10x12 block in page format */
+static const uint8_t m_block[20] = {
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0x0F, 0x0F, 0x0F, 0x0F, 0x0F, 0x0F, 0x0F, 0x0F, 0x0F, 0x0F,
+};
+
+/* Three glyphs of a custom font, 'A' to 'C', drawn from the baseline */
+static uint8_t m_font_bitmap[] = {
+    0x74, 0x63, 0xF8, 0xC6, 0x20,  // A, 5x7
+    0xF4, 0x7D, 0x18, 0xF8,        // B, 5x6
+    0xF8, 0x88, 0xF0,              // C, 4x5
+};
+static GFXglyph m_font_glyphs[] = {
+    {0, 5, 7, 7, 0, -7},
+    {5, 5, 6, 6, 1, -6},
+    {9, 4, 5, 6, 0, -4},
+};
+static const GFXfont m_font = {m_font_bitmap, m_font_glyphs, 'A', 'C', 10};
+
+/**
+ * Draws shapes that do not line up with pages, overlap, and erase each other, so the unbuffered path has to read back and merge gdram bytes.
+ * Only operations the unbuffered path supports are used, which leaves out xor bitmaps.
+ */
+template <class panel_t>
+static int m_shapes_draw(panel_t& panel) {
+    int res;
+    panel.drawRect(0, 0, 128, 64, 1);
+    panel.fillRect(5, 3, 40, 21, 1);
+    panel.fillRect(12, 9, 20, 9, 0);
+    panel.drawLine(2, 61, 125, 27, 1);
+    panel.drawLine(60, 2, 90, 60, 1);
+    panel.drawFastHLine(50, 45, 70, 1);
+    panel.drawFastVLine(100, 5, 50, 0);
+    res = panel.bitmap_draw(70, 6, m_icon, 16, 16, sh1106::BITMAP_FORMAT_PAGES, sh1106::OPERATION_COPY);
+    if (res < 0) {
+        return res;
+    }
+    res = panel.bitmap_draw(94, 13, m_icon, 16, 16, sh1106::BITMAP_FORMAT_PAGES, sh1106::OPERATION_OR);
+    if (res < 0) {
+        return res;
+    }
+    for (int16_t i = 0; i < 24; i++) {
+        panel.drawPixel(8 + i * 3, 30 + (i % 5), 1);
+    }
+    panel.setTextColor(1, 0);
+    panel.setCursor(9, 43);
+    panel.print("SH1106");
+    return 0;
+}
+
+template <class panel_t>
+static int m_scene_draw(panel_t& panel) {
+    int res = m_shapes_draw(panel);
+    return (res < 0) ? res : panel.display();
+}
+
+/**
+ * Draws a scene, then scrolls it up twice with a new line at the bottom each time, which moves the start line of the gdram.
+ */
+template <class panel_t>
+static int m_scroll_draw(panel_t& panel) {
+    int res = m_scene_draw(panel);
+    for (int i = 0; i < 2 && res >= 0; i++) {
+        res = panel.scroll_up();
+        if (res >= 0) {
+            panel.setCursor(4 + i * 40, 56);
+            panel.print(i ? "two" : "one");
+            res = panel.display();
+        }
+    }
+    return res;
+}
+
+/**
+ * Redraws the whole screen for each frame with a shadow buffer, only a block and a counter moving, so only what differs from the previous frame is sent.
+ */
+template <class panel_t>
+static int m_shadow_draw(panel_t& panel) {
+    static uint8_t shadow[WIDTH * HEIGHT / 8];
+    int res = panel.shadow_set(shadow);
+    for (int frame = 0; frame < 3 && res >= 0; frame++) {
+        panel.fillScreen(0);
+        res = m_shapes_draw(panel);
+        panel.fillRect(10 + frame * 23, 50, 12, 9, 1);
+        panel.setCursor(104, 54 - frame * 3);
+        const char digit[2] = {(char)('0' + frame), '\0'};
+        panel.print(digit);
+        if (res >= 0) {
+            res = panel.display();
+        }
+    }
+    return res;
+}
+
+/**
+ * Draws the shapes of a scene into a strip, keeping the first error in the context.
+ */
+template <class panel_t>
+static void m_strip_draw(panel_t& panel, void* context) {
+    const int res = m_shapes_draw(panel);
+    if (res < 0 && *(int*)context == 0) {
+        *(int*)context = res;
+    }
+}
+
+/**
+ * Draws a scene through render(), with a buffer holding two pages, so shapes, bitmaps and text are cut at the edges of strips.
+ */
+template <class panel_t>
+static int m_render_draw(panel_t& panel) {
+    int error = 0;
+    const int res = panel.render(m_strip_draw<panel_t>, &error);
+    return (res < 0) ? res : error;
+}
+
+/**
+ * Draws text with a glyph cache too small for it, aligned on pages or not, opaque or transparent, scaled, with a custom font, wrapped, and rotated.
+ */
+template <class panel_t>
+static int m_glyphs_draw(panel_t& panel) {
+    static uint8_t cache[SH1106_GLYPH_CACHE_ENTRIES * 16 + 192];  // The index, and room for a few glyphs so the cache gets emptied
+    int res = panel.glyph_cache_set(cache, sizeof(cache));
+    if (res < 0) {
+        return res;
+    }
+    panel.fillRect(0, 36, 128, 14, 1);
+    panel.setTextColor(1, 0);
+    panel.setCursor(0, 0);
+    panel.print("Cache 0123");
+    panel.setCursor(3, 13);
+    panel.print("unaligned");
+    panel.setTextColor(0);
+    panel.setCursor(5, 38);
+    panel.print("dark");
+    panel.setTextColor(0, 1);
+    panel.setCursor(60, 39);
+    panel.print("inverse");
+    panel.setTextColor(1);
+    panel.setTextSize(2);
+    panel.setCursor(2, 44);
+    panel.print("Ab12");
+    panel.setTextSize(1);
+    panel.setCursor(110, 20);
+    panel.print("wrap");
+    panel.setFont(&m_font);
+    panel.setCursor(60, 62);
+    panel.print("ABCAB");
+    panel.setFont();
+    panel.setRotation(1);
+    panel.setCursor(2, 20);
+    panel.print("rot");
+    panel.setRotation(0);
+    panel.setTextColor(1, 0);
+    panel.setCursor(70, 0);
+    panel.print("0123");
+    return panel.display();
+}
+
+/**
+ * Sets points, spans and scanlines, some clipped or empty, in several rotations.
+ */
+template <class panel_t>
+static int m_batch_draw(panel_t& panel) {
+    struct sh1106::point points[43];
+    for (int16_t i = 0; i < 40; i++) {
+        points[i] = {(int16_t)((i * 7) % 128), (int16_t)((i * 13) % 64)};
+    }
+    points[40] = {-1, 5};
+    points[41] = {130, 2};
+    points[42] = {5, 70};
+    static const struct sh1106::span spans[] = {
+        {-5, 3, 20}, {100, 10, 40}, {20, 20, 0}, {30, 21, -4}, {10, 63, 118}, {0, 64, 5}, {40, 17, 30},
+    };
+    static const uint8_t bits[] = {
+        0xF0, 0x30, 0x88, 0x40, 0x84, 0x80, 0x82, 0x00, 0xFF, 0xF0,
+        0x82, 0x00, 0x84, 0x80, 0x88, 0x40, 0xF0, 0x30, 0x55, 0x50,
+    };
+    const uint8_t rotations[] = {0, 1, 3};
+    for (const uint8_t rotation : rotations) {
+        panel.setRotation(rotation);
+        int res = panel.points_set(points, sizeof(points) / sizeof(points[0]), 1);
+        if (res >= 0) {
+            res = panel.spans_set(spans, sizeof(spans) / sizeof(spans[0]), rotation != 3);
+        }
+        if (res >= 0) {
+            res = panel.scanlines_draw(50 + rotation, 28, bits, 12, 10, 1);
+        }
+        if (res >= 0) {
+            res = panel.scanlines_draw(-3, 60, bits, 12, 10, 1);
+        }
+        if (res >= 0) {
+            res = panel.scanlines_draw(56, 31 + rotation * 8, bits, 12, 10, 0);
+        }
+        if (res < 0) {
+            return res;
+        }
+    }
+    panel.setRotation(0);
+    return panel.display();
+}
+
+/**
+ * Scrolls bands of pages left as a ticker would, drawing the column that appears each time, and only sending some of the steps.
+ */
+template <class panel_t>
+static int m_scroll_left_draw(panel_t& panel) {
+    int res = m_scene_draw(panel);
+    for (int i = 0; i < 40 && res >= 0; i++) {
+        res = panel.scroll_left(2, 3);
+        if (res >= 0 && i % 3 == 0) {
+            res = panel.scroll_left(7, 1);
+        }
+        if (res >= 0) {
+            panel.drawPixel(127, 16 + (i * 5) % 24, 1);
+            if (i % 8 == 7) {
+                res = panel.display();
+            }
+        }
+    }
+    return (res < 0) ? res : panel.display();
+}
+
+/**
+ * Submits frames to triple buffering, flushing after every other frame, so half of them are replaced before being sent.
+ */
+template <class panel_t>
+static int m_frames_draw(panel_t& panel) {
+    static uint8_t buffers[2][WIDTH * HEIGHT / 8];
+    int res = panel.frames_set(buffers[0], buffers[1]);
+    for (int frame = 0; frame < 4 && res >= 0; frame++) {
+        panel.fillScreen(0);
+        res = m_shapes_draw(panel);
+        panel.fillRect(frame * 30, 52, 20, 8, 1);
+        panel.setCursor(110, 2);
+        const char digit[2] = {(char)('0' + frame), '\0'};
+        panel.print(digit);
+        if (res >= 0) {
+            res = panel.frame_submit();
+        }
+        if (res >= 0 && frame % 2 == 1) {
+            res = panel.frame_flush();
+        }
+    }
+    return res;
+}
+
+/* Sprites of the compositor scene, first shown at one position, then moved to another, some of them being hidden */
+static const struct {
+    const uint8_t* bitmap;
+    const uint8_t* mask;
+    uint8_t w, h;
+    enum sh1106_compositor::rule rule;
+    int16_t x_first, y_first;
+    int16_t x, y;
+    bool visible;
+} m_sprites[] = {
+    {m_icon, NULL, 16, 16, sh1106_compositor::RULE_OR, -5, 10, 20, 12, true},
+    {m_icon, m_icon_mask, 16, 16, sh1106_compositor::RULE_OR, 40, 20, 44, 27, true},
+    {m_block, NULL, 10, 12, sh1106_compositor::RULE_XOR, 50, 30, 50, 30, true},
+    {m_block, NULL, 10, 12, sh1106_compositor::RULE_AND_NOT, 120, 58, 120, 58, false},
+    {m_block, m_icon_mask, 10, 12, sh1106_compositor::RULE_XOR, 90, 5, 118, -4, true},
+};
+
+/**
+ * Tells whether a pixel of the background of the compositor scene is lit.
+ */
+static bool m_background_get(const int x, const int y) {
+    return ((x + y) % 7) == 0 || y == 40;
+}
+
+/**
+ * Composes sprites over a background, then moves and hides some of them so only parts of the screen are composed again.
+ */
+static int m_compositor_draw(sh1106& panel) {
+    static uint8_t background[WIDTH * HEIGHT / 8];
+    memset(background, 0, sizeof(background));
+    for (int y = 0; y < HEIGHT; y++) {
+        for (int x = 0; x < WIDTH; x++) {
+            if (m_background_get(x, y)) {
+                background[(y / 8) * WIDTH + x] |= 1 << (y % 8);
+            }
+        }
+    }
+    static sh1106_compositor compositor;
+    int res = compositor.setup(panel, background);
+    for (size_t i = 0; i < sizeof(m_sprites) / sizeof(m_sprites[0]) && res >= 0; i++) {
+        res = compositor.sprite_set(i, m_sprites[i].bitmap, m_sprites[i].mask, m_sprites[i].w, m_sprites[i].h, m_sprites[i].rule);
+        if (res >= 0) {
+            res = compositor.sprite_move(i, m_sprites[i].x_first, m_sprites[i].y_first);
+        }
+        if (res >= 0) {
+            res = compositor.sprite_show(i, true);
+        }
+    }
+    if (res >= 0) {
+        res = compositor.compose();
+    }
+    if (res >= 0) {
+        res = panel.display();
+    }
+    for (size_t i = 0; i < sizeof(m_sprites) / sizeof(m_sprites[0]) && res >= 0; i++) {
+        res = compositor.sprite_move(i, m_sprites[i].x, m_sprites[i].y);
+        if (res >= 0) {
+            res = compositor.sprite_show(i, m_sprites[i].visible);
+        }
+    }
+    if (res >= 0) {
+        res = compositor.compose();
+    }
+    return (res < 0) ? res : panel.display();
+}
+
+static int m_compositor_reference(reference_panel& panel) {
+    for (int y = 0; y < HEIGHT; y++) {
+        for (int x = 0; x < WIDTH; x++) {
+            panel.drawPixel(x, y, m_background_get(x, y));
+        }
+    }
+    for (const auto& sprite : m_sprites) {
+        if (!sprite.visible) {
+            continue;
+        }
+        for (int j = 0; j < sprite.h; j++) {
+            for (int i = 0; i < sprite.w; i++) {
+                const int x = sprite.x + i, y = sprite.y + j;
+                if (sprite.mask != NULL && ((sprite.mask[(j / 8) * sprite.w + i] >> (j % 8)) & 1)) {
+                    panel.drawPixel(x, y, 0);
+                }
+                if ((sprite.bitmap[(j / 8) * sprite.w + i] >> (j % 8)) & 1) {
+                    switch (sprite.rule) {
+                        case sh1106_compositor::RULE_OR: panel.drawPixel(x, y, 1); break;
+                        case sh1106_compositor::RULE_AND_NOT: panel.drawPixel(x, y, 0); break;
+                        case sh1106_compositor::RULE_XOR: panel.drawPixel(x, y, !panel.pixel_get(x, y)); break;
+                    }
+                }
+            }
+        }
+    }
+    return 0;
+}
+
+/**
+ * Draws a frame of the animation: a header that never changes, a block moving across pages, a line and a counter.
+ */
+static void m_animation_frame_draw(reference_panel& panel, const int frame) {
+    panel.drawRect(0, 0, 128, 16, 1);
+    panel.setTextColor(1, 0);
+    panel.setCursor(4, 4);
+    panel.print("animation");
+    panel.fillRect(8 + frame * 30, 20 + frame * 3, 20, 20, 1);
+    panel.drawLine(0, 63, 127 - frame * 20, 45, 1);
+    panel.setCursor(110, 30);
+    const char digit[2] = {(char)('0' + frame), '\0'};
+    panel.print(digit);
+}
+
+/**
+ * Plays frames of the animation over a scene, the first one being complete so nothing of the scene is left.
+ */
+static int m_animation_draw(sh1106& panel, const int frames) {
+    int res = m_scene_draw(panel);
+    size_t position = 0;
+    for (int frame = 0; frame < frames && res >= 0; frame++) {
+        res = panel.animation_play(m_animation, position);
+        if (res != ((frame < 2) ? 1 : 0)) {
+            return (res < 0) ? res : -EPROTO;
+        }
+    }
+    return res;
+}
+
+static int m_image_draw(sh1106& panel) {
+    int res = m_scene_draw(panel);
+    return (res < 0) ? res : panel.image_draw(m_animation);
+}
+
+static int m_image_reference(reference_panel& panel) {
+    m_animation_frame_draw(panel, 0);
+    return 0;
+}
+
+static int m_animation_second_draw(sh1106& panel) {
+    return m_animation_draw(panel, 2);
+}
+
+static int m_animation_second_reference(reference_panel& panel) {
+    m_animation_frame_draw(panel, 1);
+    return 0;
+}
+
+static int m_animation_last_draw(sh1106& panel) {
+    return m_animation_draw(panel, 3);
+}
+
+static int m_animation_last_reference(reference_panel& panel) {
+    m_animation_frame_draw(panel, 2);
+    return 0;
+}
+
+static const struct image {
+    int (*draw)(sh1106& panel);
+    int (*reference)(reference_panel& panel);
+    const char* name;
+    bool unbuffered;      //!< Whether the scene can be drawn without a local buffer.
+    size_t buffer_pages;  //!< Pages held by the local buffer, 0 for the whole screen.
+} m_images[] = {
+    {m_scene_draw<sh1106>, m_scene_draw<reference_panel>, "scene", true, 0},
+    {m_scroll_draw<sh1106>, m_scroll_draw<reference_panel>, "scroll", true, 0},
+    {m_shadow_draw<sh1106>, m_shadow_draw<reference_panel>, "shadow", false, 0},
+    {m_render_draw<sh1106>, m_render_draw<reference_panel>, "render", false, 2},
+    {m_glyphs_draw<sh1106>, m_glyphs_draw<reference_panel>, "glyphs", false, 0},
+    {m_batch_draw<sh1106>, m_batch_draw<reference_panel>, "batch", true, 0},
+    {m_scroll_left_draw<sh1106>, m_scroll_left_draw<reference_panel>, "scroll_left", false, 0},
+    {m_frames_draw<sh1106>, m_frames_draw<reference_panel>, "frames", false, 0},
+    {m_compositor_draw, m_compositor_reference, "compositor", false, 0},
+    {m_image_draw, m_image_reference, "animation_0", true, 0},
+    {m_animation_second_draw, m_animation_second_reference, "animation_1", true, 0},
+    {m_animation_last_draw, m_animation_last_reference, "animation_2", true, 0},
+};
+
+/**
+ * Sets up a panel through a transfer path, with the emulator as the device on the other end.
+ */
+static int m_panel_setup(sh1106& panel, sh1106_emulator& emulator, const char* const path, const size_t buffer_pages) {
+    static uint8_t buffer[WIDTH * HEIGHT / 8];
+    memset(buffer, 0, sizeof(buffer));
+    if (strcmp(path, "i2c_buffered") == 0) {
+        Wire.device_attach(&emulator, 0x3C);
+        return panel.setup(Wire, 0x3C, PIN_RES, buffer, buffer_pages);
+    } else if (strcmp(path, "i2c_light") == 0) {
+        Wire.device_attach(&emulator, 0x3C);
+        return panel.setup(Wire, 0x3C, PIN_RES);
+    } else if (strcmp(path, "spi_4wires") == 0) {
+        SPI.device_attach(&emulator, PIN_CS, PIN_DC);
+        return panel.setup(SPI, 1000000, PIN_CS, PIN_DC, PIN_RES, buffer, buffer_pages);
+#if SH1106_SPI_3WIRES_GROUPS > 0
+    } else if (strcmp(path, "spi_3wires") == 0) {
+        SPI.device_attach(&emulator, PIN_CS);
+        return panel.setup(SPI, 1000000, PIN_CS, PIN_RES, buffer, buffer_pages);
+#endif
+    } else if (strcmp(path, "transport") == 0) {
+        return panel.setup(emulator, PIN_RES, buffer, buffer_pages);
+    }
+    return -EINVAL;
+}
+
+int main(int argc, char* argv[]) {
+    if (argc != 3) {
+        fprintf(stderr, "Usage: %s <i2c_buffered|i2c_light|spi_4wires|spi_3wires|transport|--update> <golden directory>\n", argv[0]);
+        return 2;
+    }
+    const bool update = (strcmp(argv[1], "--update") == 0);
+    const char* const path = argv[1];
+
+    int failures = 0;
+    for (const struct image& image : m_images) {
+        char filename[512];
+        snprintf(filename, sizeof(filename), "%s/%s.pbm", argv[2], image.name);
+
+        /* Draw the reference */
+        static uint8_t expected[4096];
+        reference_panel reference;
+        int res = image.reference(reference);
+        if (res < 0) {
+            printf("FAIL %s: reference drawing failed (%d)\n", image.name, res);
+            failures++;
+            continue;
+        }
+        const size_t expected_length = reference.pbm_export(expected, sizeof(expected));
+
+        /* Write it as the golden image */
+        if (update) {
+            FILE* file = fopen(filename, "wb");
+            if (file == NULL || fwrite(expected, 1, expected_length, file) != expected_length) {
+                printf("FAIL %s: could not write\n", filename);
+                failures++;
+            }
+            if (file != NULL) {
+                fclose(file);
+            }
+            continue;
+        }
+
+        /* Or check that the reference still draws the golden image */
+        static uint8_t pbm[4096];
+        FILE* file = fopen(filename, "rb");
+        if (file == NULL) {
+            printf("FAIL %s %s: could not read %s\n", path, image.name, filename);
+            failures++;
+            continue;
+        }
+        const size_t length = fread(pbm, 1, sizeof(pbm), file);
+        fclose(file);
+        if (length != expected_length || memcmp(pbm, expected, length) != 0) {
+            printf("FAIL %s %s: the reference does not match the golden image\n", path, image.name);
+            failures++;
+            continue;
+        }
+
+        /* Draw through the driver */
+        if (!image.unbuffered && strcmp(path, "i2c_light") == 0) {
+            printf("SKIP %s %s: needs a local buffer\n", path, image.name);
+            continue;
+        }
+        sh1106 panel(WIDTH, HEIGHT);
+        sh1106_emulator emulator(WIDTH, HEIGHT);
+        res = m_panel_setup(panel, emulator, path, image.buffer_pages);
+        if (res >= 0) {
+            res = panel.clear();
+        }
+        if (res >= 0) {
+            res = image.draw(panel);
+        }
+        if (res < 0) {
+            printf("FAIL %s %s: drawing failed (%d)\n", path, image.name, res);
+            failures++;
+            continue;
+        }
+
+        /* And compare what the emulator shows against the golden image */
+        size_t mismatches = 0;
+        res = emulator.pbm_compare(pbm, length, &mismatches);
+        if (res != 0) {
+            printf("FAIL %s %s: %zu pixels differ (%d)\n", path, image.name, mismatches, res);
+            failures++;
+        } else {
+            printf("PASS %s %s\n", path, image.name);
+        }
+    }
+    return (failures == 0) ? 0 : 1;
+}
@@ -0,0 +1,231 @@
+/* Self header */
+#include "Adafruit_GFX.h"
+
+/* C/C++ libraries */
+#include <stdlib.h>
+
+/**
+ * Placeholder for a column of a glyph of the classic font, 7 rows high with the top row in the lsb.
+ */
+static uint8_t m_glyph_column(const unsigned char c, const int8_t i) {
+    if (c == ' ') {
+        return 0x00;
+    }
+    return (uint8_t)((c * 37 + i * 11) ^ (c >> 2)) & 0x7F;
+}
+
+void Adafruit_GFX::writePixel(int16_t x, int16_t y, uint16_t color) {
+    drawPixel(x, y, color);
+}
+
+void Adafruit_GFX::writeFillRect(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color) {
+    fillRect(x, y, w, h, color);
+}
+
+void Adafruit_GFX::writeFastVLine(int16_t x, int16_t y, int16_t h, uint16_t color) {
+    drawFastVLine(x, y, h, color);
+}
+
+void Adafruit_GFX::writeFastHLine(int16_t x, int16_t y, int16_t w, uint16_t color) {
+    drawFastHLine(x, y, w, color);
+}
+
+void Adafruit_GFX::writeLine(int16_t x0, int16_t y0, int16_t x1, int16_t y1, uint16_t color) {
+    const int16_t dx = abs(x1 - x0), dy = -abs(y1 - y0);
+    const int16_t sx = (x0 < x1) ? 1 : -1, sy = (y0 < y1) ? 1 : -1;
+    int16_t error = dx + dy;
+    while (true) {
+        writePixel(x0, y0, color);
+        if (x0 == x1 && y0 == y1) {
+            break;
+        }
+        const int16_t error2 = 2 * error;
+        if (error2 >= dy) {
+            error += dy;
+            x0 += sx;
+        }
+        if (error2 <= dx) {
+            error += dx;
+            y0 += sy;
+        }
+    }
+}
+
+void Adafruit_GFX::setRotation(uint8_t r) {
+    rotation = r & 3;
+    if (rotation & 1) {
+        _width = HEIGHT;
+        _height = WIDTH;
+    } else {
+        _width = WIDTH;
+        _height = HEIGHT;
+    }
+}
+
+void Adafruit_GFX::invertDisplay(bool i) {
+    (void)i;
+}
+
+void Adafruit_GFX::drawFastVLine(int16_t x, int16_t y, int16_t h, uint16_t color) {
+    startWrite();
+    writeLine(x, y, x, y + h - 1, color);
+    endWrite();
+}
+
+void Adafruit_GFX::drawFastHLine(int16_t x, int16_t y, int16_t w, uint16_t color) {
+    startWrite();
+    writeLine(x, y, x + w - 1, y, color);
+    endWrite();
+}
+
+void Adafruit_GFX::fillRect(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color) {
+    startWrite();
+    for (int16_t i = x; i < x + w; i++) {
+        writeFastVLine(i, y, h, color);
+    }
+    endWrite();
+}
+
+void Adafruit_GFX::fillScreen(uint16_t color) {
+    fillRect(0, 0, _width, _height, color);
+}
+
+void Adafruit_GFX::drawLine(int16_t x0, int16_t y0, int16_t x1, int16_t y1, uint16_t color) {
+    if (x0 == x1) {
+        if (y0 > y1) {
+            int16_t t = y0;
+            y0 = y1;
+            y1 = t;
+        }
+        drawFastVLine(x0, y0, y1 - y0 + 1, color);
+    } else if (y0 == y1) {
+        if (x0 > x1) {
+            int16_t t = x0;
+            x0 = x1;
+            x1 = t;
+        }
+        drawFastHLine(x0, y0, x1 - x0 + 1, color);
+    } else {
+        startWrite();
+        writeLine(x0, y0, x1, y1, color);
+        endWrite();
+    }
+}
+
+void Adafruit_GFX::drawRect(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color) {
+    startWrite();
+    writeFastHLine(x, y, w, color);
+    writeFastHLine(x, y + h - 1, w, color);
+    writeFastVLine(x, y, h, color);
+    writeFastVLine(x + w - 1, y, h, color);
+    endWrite();
+}
+
+void Adafruit_GFX::drawChar(int16_t x, int16_t y, unsigned char c, uint16_t color, uint16_t bg, uint8_t size_x, uint8_t size_y) {
+
+    /* Classic font */
+    if (gfxFont == NULL) {
+        if (x >= _width || y >= _height || x + 6 * size_x - 1 < 0 || y + 8 * size_y - 1 < 0) {
+            return;
+        }
+        if (!_cp437 && c >= 176) {
+            c++;
+        }
+        startWrite();
+        for (int8_t i = 0; i < 5; i++) {
+            uint8_t line = m_glyph_column(c, i);
+            for (int8_t j = 0; j < 8; j++, line >>= 1) {
+                if (line & 1) {
+                    if (size_x == 1 && size_y == 1) {
+                        writePixel(x + i, y + j, color);
+                    } else {
+                        writeFillRect(x + i * size_x, y + j * size_y, size_x, size_y, color);
+                    }
+                } else if (bg != color) {
+                    if (size_x == 1 && size_y == 1) {
+                        writePixel(x + i, y + j, bg);
+                    } else {
+                        writeFillRect(x + i * size_x, y + j * size_y, size_x, size_y, bg);
+                    }
+                }
+            }
+        }
+        if (bg != color) {
+            if (size_x == 1 && size_y == 1) {
+                writeFastVLine(x + 5, y, 8, bg);
+            } else {
+                writeFillRect(x + 5 * size_x, y, size_x, 8 * size_y, bg);
+            }
+        }
+        endWrite();
+        return;
+    }
+
+    /* Custom font */
+    c -= (uint8_t)gfxFont->first;
+    const GFXglyph* glyph = &gfxFont->glyph[c];
+    uint16_t offset = glyph->bitmapOffset;
+    uint8_t bits = 0, bit = 0;
+    startWrite();
+    for (uint8_t yy = 0; yy < glyph->height; yy++) {
+        for (uint8_t xx = 0; xx < glyph->width; xx++) {
+            if (!(bit++ & 7)) {
+                bits = gfxFont->bitmap[offset++];
+            }
+            if (bits & 0x80) {
+                if (size_x == 1 && size_y == 1) {
+                    writePixel(x + glyph->xOffset + xx, y + glyph->yOffset + yy, color);
+                } else {
+                    writeFillRect(x + (glyph->xOffset + xx) * size_x, y + (glyph->yOffset + yy) * size_y, size_x, size_y, color);
+                }
+            }
+            bits <<= 1;
+        }
+    }
+    endWrite();
+}
+
+size_t Adafruit_GFX::write(uint8_t c) {
+
+    /* Classic font */
+    if (gfxFont == NULL) {
+        if (c == '\n') {
+            cursor_x = 0;
+            cursor_y += textsize_y * 8;
+        } else if (c != '\r') {
+            if (wrap && (cursor_x + textsize_x * 6) > _width) {
+                cursor_x = 0;
+                cursor_y += textsize_y * 8;
+            }
+            drawChar(cursor_x, cursor_y, c, textcolor, textbgcolor, textsize_x, textsize_y);
+            cursor_x += textsize_x * 6;
+        }
+        return 1;
+    }
+
+    /* Custom font */
+    if (c == '\n') {
+        cursor_x = 0;
+        cursor_y += (int16_t)textsize_y * gfxFont->yAdvance;
+    } else if (c != '\r' && c >= gfxFont->first && c <= gfxFont->last) {
+        const GFXglyph* glyph = &gfxFont->glyph[c - gfxFont->first];
+        if (glyph->width > 0 && glyph->height > 0) {
+            if (wrap && (cursor_x + textsize_x * (glyph->xOffset + glyph->width)) > _width) {
+                cursor_x = 0;
+                cursor_y += (int16_t)textsize_y * gfxFont->yAdvance;
+            }
+            drawChar(cursor_x, cursor_y, c, textcolor, textbgcolor, textsize_x, textsize_y);
+        }
+        cursor_x += glyph->xAdvance * (int16_t)textsize_x;
+    }
+    return 1;
+}
+
+void Adafruit_GFX::setFont(const GFXfont* f) {
+    if (f != NULL && gfxFont == NULL) {
+        cursor_y += 6;
+    } else if (f == NULL && gfxFont != NULL) {
+        cursor_y -= 6;
+    }
+    gfxFont = (GFXfont*)f;
+}
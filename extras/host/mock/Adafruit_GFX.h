@@ -0,0 +1,92 @@
+#ifndef ADAFRUIT_GFX_H
+#define ADAFRUIT_GFX_H
+
+/* Arduino libraries */
+#include <Arduino.h>
+
+/* Project libraries */
+#include "gfxfont.h"
+
+/**
+ * Subset of Adafruit_GFX used by the library, for host builds.
+ * The drawing primitives go through the same virtual methods as the real one, so the overrides of the driver are exercised the same way.
+ * The classic font is replaced by placeholder glyphs of the same 5x7 size, which keeps the traffic of text representative.
+ */
+class Adafruit_GFX : public Print {
+
+   public:
+    Adafruit_GFX(int16_t w, int16_t h) : WIDTH(w), HEIGHT(h), _width(w), _height(h) {}
+
+    /* Drawing */
+    virtual void drawPixel(int16_t x, int16_t y, uint16_t color) = 0;
+    virtual void startWrite(void) {}
+    virtual void writePixel(int16_t x, int16_t y, uint16_t color);
+    virtual void writeFillRect(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color);
+    virtual void writeFastVLine(int16_t x, int16_t y, int16_t h, uint16_t color);
+    virtual void writeFastHLine(int16_t x, int16_t y, int16_t w, uint16_t color);
+    virtual void writeLine(int16_t x0, int16_t y0, int16_t x1, int16_t y1, uint16_t color);
+    virtual void endWrite(void) {}
+    virtual void setRotation(uint8_t r);
+    virtual void invertDisplay(bool i);
+    virtual void drawFastVLine(int16_t x, int16_t y, int16_t h, uint16_t color);
+    virtual void drawFastHLine(int16_t x, int16_t y, int16_t w, uint16_t color);
+    virtual void fillRect(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color);
+    virtual void fillScreen(uint16_t color);
+    virtual void drawLine(int16_t x0, int16_t y0, int16_t x1, int16_t y1, uint16_t color);
+    virtual void drawRect(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color);
+
+    /* Text */
+    void drawChar(int16_t x, int16_t y, unsigned char c, uint16_t color, uint16_t bg, uint8_t size_x, uint8_t size_y);
+    virtual size_t write(uint8_t c);
+    void setCursor(int16_t x, int16_t y) {
+        cursor_x = x;
+        cursor_y = y;
+    }
+    void setTextColor(uint16_t c) {
+        textcolor = textbgcolor = c;
+    }
+    void setTextColor(uint16_t c, uint16_t bg) {
+        textcolor = c;
+        textbgcolor = bg;
+    }
+    void setTextSize(uint8_t s) {
+        textsize_x = textsize_y = (s > 0) ? s : 1;
+    }
+    void setTextWrap(bool w) {
+        wrap = w;
+    }
+    void setFont(const GFXfont* f = NULL);
+    void cp437(bool x = true) {
+        _cp437 = x;
+    }
+
+    /* State */
+    int16_t width(void) const {
+        return _width;
+    }
+    int16_t height(void) const {
+        return _height;
+    }
+    uint8_t getRotation(void) const {
+        return rotation;
+    }
+    int16_t getCursorX(void) const {
+        return cursor_x;
+    }
+    int16_t getCursorY(void) const {
+        return cursor_y;
+    }
+
+   protected:
+    int16_t WIDTH, HEIGHT;
+    int16_t _width, _height;
+    int16_t cursor_x = 0, cursor_y = 0;
+    uint16_t textcolor = 0xFFFF, textbgcolor = 0xFFFF;
+    uint8_t textsize_x = 1, textsize_y = 1;
+    uint8_t rotation = 0;
+    bool wrap = true;
+    bool _cp437 = false;
+    GFXfont* gfxFont = NULL;
+};
+
+#endif
@@ -0,0 +1,47 @@
+/* Self header */
+#include "Arduino.h"
+
+/* Simulated time in nanoseconds */
+static uint64_t m_time_ns = 0;
+
+/* Levels of the pins */
+static uint8_t m_pins[256] = {};
+
+void pinMode(const int pin, const int mode) {
+    (void)pin;
+    (void)mode;
+}
+
+void digitalWrite(const int pin, const int value) {
+    if (pin >= 0 && pin < 256) {
+        m_pins[pin] = (value != LOW) ? HIGH : LOW;
+    }
+}
+
+int digitalRead(const int pin) {
+    return (pin >= 0 && pin < 256) ? m_pins[pin] : LOW;
+}
+
+void delay(const unsigned long ms) {
+    m_time_ns += (uint64_t)ms * 1000000;
+}
+
+void delayMicroseconds(const unsigned int us) {
+    m_time_ns += (uint64_t)us * 1000;
+}
+
+unsigned long micros(void) {
+    return (unsigned long)(m_time_ns / 1000);
+}
+
+unsigned long millis(void) {
+    return (unsigned long)(m_time_ns / 1000000);
+}
+
+void host_time_advance(const uint64_t ns) {
+    m_time_ns += ns;
+}
+
+uint64_t host_time_get(void) {
+    return m_time_ns;
+}
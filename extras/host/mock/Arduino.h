@@ -0,0 +1,52 @@
+#ifndef ARDUINO_H
+#define ARDUINO_H
+
+/* C/C++ libraries */
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+/* Subset of the arduino core used by the library, for host builds */
+#define HIGH 1
+#define LOW 0
+#define INPUT 0
+#define OUTPUT 1
+#define MSBFIRST 1
+#define PROGMEM
+#define pgm_read_byte(address) (*(const uint8_t*)(address))
+#define pgm_read_word(address) (*(const uint16_t*)(address))
+#define memcpy_P memcpy
+
+void pinMode(const int pin, const int mode);
+void digitalWrite(const int pin, const int value);
+int digitalRead(const int pin);
+void delay(const unsigned long ms);
+void delayMicroseconds(const unsigned int us);
+unsigned long micros(void);
+unsigned long millis(void);
+
+class Print {
+   public:
+    virtual ~Print(void) {}
+    virtual size_t write(uint8_t c) = 0;
+    size_t print(const char* text) {
+        size_t count = 0;
+        while (*text != '\0') {
+            count += write((uint8_t)*text++);
+        }
+        return count;
+    }
+};
+
+/* Simulated time, only moved forward by delays and by the bus models, so timings do not depend on the host */
+void host_time_advance(const uint64_t ns);
+uint64_t host_time_get(void);
+
+/* Traffic of a simulated bus */
+struct host_bus_stats {
+    uint32_t transactions;  //!< I2c transmissions and requests, or spi transactions.
+    uint32_t bytes;         //!< Bytes clocked, not counting i2c addresses.
+    uint64_t ns;            //!< Time the bus was busy, in nanoseconds.
+};
+
+#endif
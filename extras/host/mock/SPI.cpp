@@ -0,0 +1,101 @@
+/* Self header */
+#include "SPI.h"
+
+/* Project libraries */
+#include "sh1106_emulator.h"
+
+SPIClass SPI;
+
+void SPIClass::beginTransaction(SPISettings settings) {
+    if (settings.clock > 0) {
+        m_frequency = settings.clock;
+    }
+    m_stats.transactions++;
+    m_stats.ns += m_overhead_ns;
+    host_time_advance(m_overhead_ns);
+}
+
+void SPIClass::endTransaction(void) {
+    m_selected = false;
+}
+
+uint8_t SPIClass::transfer(uint8_t byte) {
+    const uint64_t ns = 8 * 1000000000ull / m_frequency;
+    m_stats.bytes++;
+    m_stats.ns += ns;
+    host_time_advance(ns);
+    m_receive(byte);
+    return 0x00;
+}
+
+/**
+ * Sends bytes, overwriting them with what was received, which is always zeros as the device does not answer.
+ */
+void SPIClass::transfer(void* buffer, size_t count) {
+    uint8_t* bytes = (uint8_t*)buffer;
+    for (size_t i = 0; i < count; i++) {
+        bytes[i] = transfer(bytes[i]);
+    }
+}
+
+/**
+ * Attaches the device that receives the bytes sent while its chip select is low.
+ * @param[in] device The emulated controller, or NULL to detach it.
+ * @param[in] pin_cs The chip select pin of the device.
+ * @param[in] pin_dc The data/command pin of the device, or -1 for 3-wires spi.
+ */
+void SPIClass::device_attach(sh1106_emulator* const device, const int pin_cs, const int pin_dc) {
+    m_device = device;
+    m_pin_cs = pin_cs;
+    m_pin_dc = pin_dc;
+    m_selected = false;
+}
+
+/**
+ * Sets the time spent in software and toggling the chip select for each transaction, added to the time of the bus.
+ */
+void SPIClass::overhead_set(const uint32_t ns) {
+    m_overhead_ns = ns;
+}
+
+const struct host_bus_stats& SPIClass::stats_get(void) const {
+    return m_stats;
+}
+
+void SPIClass::stats_reset(void) {
+    m_stats = {};
+}
+
+/**
+ * Hands a byte over to the attached device if it is selected.
+ */
+void SPIClass::m_receive(const uint8_t byte) {
+    if (m_device == NULL || digitalRead(m_pin_cs) != LOW) {
+        m_selected = false;
+        return;
+    }
+
+    /* A new selection starts a new word */
+    if (!m_selected) {
+        m_selected = true;
+        m_word = 0;
+        m_word_bits = 0;
+    }
+
+    /* With a data/command pin, the byte is complete */
+    if (m_pin_dc >= 0) {
+        m_device->write(digitalRead(m_pin_dc) == HIGH, &byte, 1);
+        return;
+    }
+
+    /* In 3-wires, shift the bits into 9-bit words, msb first */
+    for (int8_t bit = 7; bit >= 0; bit--) {
+        m_word = (m_word << 1) | ((byte >> bit) & 1);
+        if (++m_word_bits == 9) {
+            const uint8_t data = m_word & 0xFF;
+            m_device->write((m_word & 0x100) != 0, &data, 1);
+            m_word = 0;
+            m_word_bits = 0;
+        }
+    }
+}
@@ -0,0 +1,57 @@
+#ifndef SPI_H
+#define SPI_H
+
+/* Arduino libraries */
+#include <Arduino.h>
+
+#define SPI_MODE0 0x00
+
+class sh1106_emulator;
+
+class SPISettings {
+   public:
+    SPISettings(void) {}
+    SPISettings(uint32_t clock, uint8_t bitOrder, uint8_t dataMode) : clock(clock) {
+        (void)bitOrder;
+        (void)dataMode;
+    }
+    uint32_t clock = 4000000;
+};
+
+/**
+ * Model of a spi controller for host builds, with a device that can be attached to it and the time the transfers would take on a real bus.
+ * Each byte costs 8 clocks at the frequency of the current transaction, and a fixed overhead can be added to each transaction for the time spent in software and toggling the chip select.
+ * With a data/command pin, bytes go to the device as commands or data depending on its level. Without, they are decoded as the 9-bit words of 3-wires spi, the first bit of each word telling data from commands.
+ */
+class SPIClass {
+
+   public:
+    /* Arduino interface */
+    void begin(void) {}
+    void beginTransaction(SPISettings settings);
+    void endTransaction(void);
+    uint8_t transfer(uint8_t byte);
+    void transfer(void* buffer, size_t count);
+
+    /* Host only */
+    void device_attach(sh1106_emulator* const device, const int pin_cs, const int pin_dc = -1);
+    void overhead_set(const uint32_t ns);
+    const struct host_bus_stats& stats_get(void) const;
+    void stats_reset(void);
+
+   protected:
+    uint32_t m_frequency = 4000000;
+    uint32_t m_overhead_ns = 0;
+    sh1106_emulator* m_device = NULL;
+    int m_pin_cs = -1;
+    int m_pin_dc = -1;
+    bool m_selected = false;  //!< Whether the chip select was low during the last byte.
+    uint16_t m_word = 0;      //!< Bits of the 9-bit word being received in 3-wires.
+    uint8_t m_word_bits = 0;  //!< Number of bits of the word received so far.
+    struct host_bus_stats m_stats = {};
+    void m_receive(const uint8_t byte);
+};
+
+extern SPIClass SPI;
+
+#endif
@@ -0,0 +1,130 @@
+/* Self header */
+#include "Wire.h"
+
+/* Project libraries */
+#include "sh1106_emulator.h"
+
+TwoWire Wire;
+
+/**
+ * Sets the frequency of the clock, usually 100000, 400000 or 1000000.
+ */
+void TwoWire::setClock(uint32_t frequency) {
+    if (frequency > 0) {
+        m_frequency = frequency;
+    }
+}
+
+void TwoWire::beginTransmission(uint8_t address) {
+    m_address = address;
+    m_tx_length = 0;
+}
+
+/**
+ * Queues a byte, which is dropped once the transmit buffer is full, as the avr core does.
+ */
+size_t TwoWire::write(uint8_t byte) {
+    if (m_tx_length >= BUFFER_LENGTH) {
+        return 0;
+    }
+    m_tx[m_tx_length++] = byte;
+    return 1;
+}
+
+size_t TwoWire::write(const uint8_t* bytes, size_t length) {
+    size_t count = 0;
+    while (count < length && write(bytes[count]) == 1) {
+        count++;
+    }
+    return count;
+}
+
+/**
+ * Sends the queued bytes to the attached device.
+ * @return 0 in case of success, 2 if no device answered the address, or 4 if the device rejected the bytes.
+ */
+uint8_t TwoWire::endTransmission(bool stop) {
+    m_bus_time(m_tx_length, stop);
+    m_stats.transactions++;
+    m_stats.bytes += m_tx_length;
+    if (m_device == NULL || m_address != m_device_address) {
+        return 2;
+    }
+    if (m_device->i2c_receive(m_tx, m_tx_length) < 0) {
+        return 4;
+    }
+    return 0;
+}
+
+/**
+ * Reads bytes from the attached device.
+ * @return The number of bytes read, 0 if no device answered the address.
+ */
+uint8_t TwoWire::requestFrom(uint8_t address, uint8_t quantity, uint8_t stop) {
+    if (quantity > BUFFER_LENGTH) {
+        quantity = BUFFER_LENGTH;
+    }
+    m_rx_length = 0;
+    m_rx_index = 0;
+    m_stats.transactions++;
+    if (m_device == NULL || address != m_device_address) {
+        m_bus_time(0, stop != 0);
+        return 0;
+    }
+    m_bus_time(quantity, stop != 0);
+    m_stats.bytes += quantity;
+    m_device->i2c_request(m_rx, quantity);
+    m_rx_length = quantity;
+    return quantity;
+}
+
+int TwoWire::available(void) {
+    return m_rx_length - m_rx_index;
+}
+
+int TwoWire::read(void) {
+    if (m_rx_index >= m_rx_length) {
+        return -1;
+    }
+    return m_rx[m_rx_index++];
+}
+
+/**
+ * Attaches the device that answers transactions sent to the given address.
+ * @param[in] device The emulated controller, or NULL to detach it.
+ * @param[in] address The 7-bit address of the device.
+ */
+void TwoWire::device_attach(sh1106_emulator* const device, const uint8_t address) {
+    m_device = device;
+    m_device_address = address;
+}
+
+/**
+ * Sets the time spent by the core in software for each transaction, added to the time of the bus.
+ */
+void TwoWire::overhead_set(const uint32_t ns) {
+    m_overhead_ns = ns;
+}
+
+const struct host_bus_stats& TwoWire::stats_get(void) const {
+    return m_stats;
+}
+
+void TwoWire::stats_reset(void) {
+    m_stats = {};
+}
+
+/**
+ * Moves the simulated time forward by the duration of a transaction.
+ * @param[in] bytes The number of bytes following the address.
+ * @param[in] stop Whether the transaction ends with a stop condition, or leaves the bus for a repeated start.
+ */
+void TwoWire::m_bus_time(const size_t bytes, const bool stop) {
+    uint64_t half_periods = 2 + 18 * (1 + bytes);  // Start or repeated start, then address and bytes with their acknowledge
+    if (stop) {
+        half_periods += 2 + 1;  // Stop, then bus free time
+    }
+    const uint64_t ns = half_periods * 1000000000ull / (2ull * m_frequency) + m_overhead_ns;
+    m_stats.ns += ns;
+    host_time_advance(ns);
+}
@@ -0,0 +1,55 @@
+#ifndef WIRE_H
+#define WIRE_H
+
+/* Arduino libraries */
+#include <Arduino.h>
+
+/* Size of the transmit and receive buffers, as in the avr core */
+#define BUFFER_LENGTH 32
+
+class sh1106_emulator;
+
+/**
+ * Model of an i2c controller for host builds, with a device that can be attached to it and the time the transfers would take on a real bus.
+ * Each transaction costs a start condition, the address byte and 9 clocks per byte for the acknowledge, then a stop condition and the bus free time before the next start.
+ * Start and stop are counted as one clock period each and the bus free time as half of one, which is what the standard mode, fast mode and fast mode plus minimums amount to.
+ * A fixed overhead can be added to each transaction for the time the core spends in software.
+ */
+class TwoWire {
+
+   public:
+    /* Arduino interface */
+    void begin(void) {}
+    void setClock(uint32_t frequency);
+    void beginTransmission(uint8_t address);
+    size_t write(uint8_t byte);
+    size_t write(const uint8_t* bytes, size_t length);
+    uint8_t endTransmission(bool stop = true);
+    uint8_t requestFrom(uint8_t address, uint8_t quantity, uint8_t stop = 1);
+    int available(void);
+    int read(void);
+
+    /* Host only */
+    void device_attach(sh1106_emulator* const device, const uint8_t address);
+    void overhead_set(const uint32_t ns);
+    const struct host_bus_stats& stats_get(void) const;
+    void stats_reset(void);
+
+   protected:
+    uint32_t m_frequency = 100000;
+    uint32_t m_overhead_ns = 0;
+    sh1106_emulator* m_device = NULL;
+    uint8_t m_device_address = 0;
+    uint8_t m_address = 0;
+    uint8_t m_tx[BUFFER_LENGTH];
+    size_t m_tx_length = 0;
+    uint8_t m_rx[BUFFER_LENGTH];
+    size_t m_rx_length = 0;
+    size_t m_rx_index = 0;
+    struct host_bus_stats m_stats = {};
+    void m_bus_time(const size_t bytes, const bool stop);
+};
+
+extern TwoWire Wire;
+
+#endif
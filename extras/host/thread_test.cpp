@@ -0,0 +1,158 @@
+/**
+ * Draws frames on one thread and sends them from another with triple buffering, and checks that the emulated controller only ever shows whole frames.
+ * Each frame carries its number in the first columns of the top page, and a pattern derived from it over the rest of the screen, so a frame mixing two submitted ones is caught.
+ * Every submitted frame must be either sent or reported as skipped by frame_submit(), and frames must be sent in order. Build with SH1106_HOST_TSAN to also check for data races.
+ */
+
+/* C/C++ libraries */
+#include <stdio.h>
+#include <atomic>
+#include <thread>
+
+/* Arduino libraries */
+#include <Arduino.h>
+
+/* Project libraries */
+#include "sh1106.h"
+#include "sh1106_emulator.h"
+
+/* Frames drawn by the producer */
+#define FRAMES 600
+
+/* Columns of the top page holding the number of the frame, one bit per column */
+#define NUMBER_COLUMNS 16
+
+/**
+ * Tells whether a pixel is lit in a frame, outside of the columns holding its number.
+ */
+static bool m_pattern_get(const uint32_t frame, const int x, const int y) {
+    return ((x * 3 + y + frame) % 5) == 0;
+}
+
+static void m_frame_draw(sh1106& panel, const uint32_t frame) {
+    panel.fillScreen(0);
+    for (int x = 0; x < 128; x++) {
+        if (x < NUMBER_COLUMNS && (frame & (1u << x))) {
+            panel.drawFastVLine(x, 0, 8, 1);
+        }
+        for (int y = (x < NUMBER_COLUMNS) ? 8 : 0; y < 64; y++) {
+            if (m_pattern_get(frame, x, y)) {
+                panel.drawPixel(x, y, 1);
+            }
+        }
+    }
+}
+
+/**
+ * Reads the number of the frame shown, and checks the rest of the screen against it.
+ * @return The number of the frame, or -1 if the screen does not hold a whole frame.
+ */
+static int32_t m_frame_check(const sh1106_emulator& emulator) {
+    uint32_t frame = 0;
+    for (int x = 0; x < NUMBER_COLUMNS; x++) {
+        const uint8_t column = emulator.gdram_get(0, 2 + x);
+        if (column == 0xFF) {
+            frame |= 1u << x;
+        } else if (column != 0x00) {
+            return -1;
+        }
+    }
+    for (int x = 0; x < 128; x++) {
+        for (int y = (x < NUMBER_COLUMNS) ? 8 : 0; y < 64; y++) {
+            if (emulator.pixel_get(x, y) != m_pattern_get(frame, x, y)) {
+                return -1;
+            }
+        }
+    }
+    return frame;
+}
+
+/**
+ * Runs the producer and the consumer, with or without a shadow buffer.
+ * @return The number of failures.
+ */
+static int m_run(const bool shadowed) {
+    static uint8_t buffers[3][128 * 8];
+    static uint8_t shadow[128 * 8];
+    const char* const name = shadowed ? "shadow" : "plain";
+    int failures = 0;
+
+    sh1106 panel(128, 64);
+    sh1106_emulator emulator(128, 64);
+    if (panel.setup(emulator, -1, buffers[0]) < 0 || panel.frames_set(buffers[1], buffers[2]) < 0 || (shadowed && panel.shadow_set(shadow) < 0)) {
+        printf("FAIL %s: setup\n", name);
+        return 1;
+    }
+
+    /* Without a consumer, a frame submitted over one that was not sent yet replaces it */
+    m_frame_draw(panel, 1);
+    const int first = panel.frame_submit();
+    m_frame_draw(panel, 2);
+    const int second = panel.frame_submit();
+    const int flushed = panel.frame_flush();
+    const int again = panel.frame_flush();
+    if (first != 0 || second != 1 || flushed != 1 || again != 0 || m_frame_check(emulator) != 2) {
+        printf("FAIL %s: skipped frame not reported (%d %d %d %d)\n", name, first, second, flushed, again);
+        failures++;
+    }
+
+    /* Then draw and send in parallel */
+    std::atomic<bool> done(false);
+    uint32_t skipped = 0;
+    std::thread producer([&]() {
+        for (uint32_t frame = 3; frame < 3 + FRAMES; frame++) {
+            m_frame_draw(panel, frame);
+            if (panel.frame_submit() == 1) {
+                skipped++;
+            }
+        }
+        done.store(true);
+    });
+    uint32_t sent = 0;
+    int32_t last = 2;
+    while (true) {
+        const bool finished = done.load();
+        const int res = panel.frame_flush();
+        if (res < 0) {
+            printf("FAIL %s: flush (%d)\n", name, res);
+            failures++;
+            break;
+        }
+        if (res == 0) {
+            if (finished) {
+                break;
+            }
+            std::this_thread::yield();
+            continue;
+        }
+        sent++;
+        const int32_t frame = m_frame_check(emulator);
+        if (frame < 0) {
+            printf("FAIL %s: torn frame after %d\n", name, last);
+            failures++;
+        } else if (frame <= last) {
+            printf("FAIL %s: frame %d sent after %d\n", name, frame, last);
+            failures++;
+        } else {
+            last = frame;
+        }
+    }
+    producer.join();
+
+    /* Every frame was either sent or skipped, the last one being sent */
+    if (sent + skipped != FRAMES || last != 2 + FRAMES) {
+        printf("FAIL %s: %u frames sent and %u skipped out of %u, last %d\n", name, sent, skipped, FRAMES, last);
+        failures++;
+    }
+    if (failures == 0) {
+        printf("PASS %s: %u frames sent, %u skipped\n", name, sent, skipped);
+    }
+    return failures;
+}
+
+int main(void) {
+    int failures = 0;
+    failures += m_run(false);
+    failures += m_run(true);
+    return (failures == 0) ? 0 : 1;
+}
@@ -0,0 +1,173 @@
+#!/usr/bin/env python3
+"""
+Converts images into the compressed format played by sh1106::image_draw() and sh1106::animation_play().
+
+Each input file is one frame. PBM files (P1 and P4) are read directly, other formats (PNG, GIF, ...) need Pillow.
+The output is a C header holding the frames in program memory, for example:
+
+    python3 image_convert.py --name splash splash.png > splash.h
+    python3 image_convert.py --name spinner spinner_*.pbm > spinner.h
+"""
+
+import argparse
+import os
+import sys
+
+TOKEN_SKIP = 0x00
+TOKEN_REPEAT = 0x40
+TOKEN_LITERAL = 0x80
+TOKEN_ZEROS = 0xC0
+TOKEN_COUNT_MAX = 64
+
+
+def pbm_read(path):
+    """Returns (width, height, pixels) of a PBM file, with pixels a list of rows of 0 (white) or 1 (black)."""
+    with open(path, "rb") as file:
+        data = file.read()
+    fields = []
+    position = 0
+    while len(fields) < 3:
+        while data[position:position + 1].isspace():
+            position += 1
+        if data[position:position + 1] == b"#":
+            while data[position:position + 1] not in (b"\n", b""):
+                position += 1
+            continue
+        start = position
+        while not data[position:position + 1].isspace():
+            position += 1
+        fields.append(data[start:position])
+    magic, width, height = fields[0], int(fields[1]), int(fields[2])
+    if magic == b"P4":
+        position += 1
+        stride = (width + 7) // 8
+        return width, height, [[(data[position + y * stride + x // 8] >> (7 - x % 8)) & 1 for x in range(width)] for y in range(height)]
+    if magic == b"P1":
+        bits = [int(c) for c in data[position:].decode("ascii") if c in "01"]
+        return width, height, [bits[y * width:(y + 1) * width] for y in range(height)]
+    raise ValueError("%s: unsupported PBM variant" % path)
+
+
+def image_read(path, threshold):
+    """Returns (width, height, pixels) of an image, with pixels a list of rows of 1 where the pixel should be lit."""
+    if os.path.splitext(path)[1].lower() == ".pbm":
+        width, height, pixels = pbm_read(path)
+        return width, height, [[1 - p for p in row] for row in pixels]  # In PBM, 1 is black
+    try:
+        from PIL import Image
+    except ImportError:
+        sys.exit("%s: reading this format needs Pillow (pip install pillow), or convert it to PBM first" % path)
+    image = Image.open(path).convert("L")
+    width, height = image.size
+    data = list(image.getdata())
+    return width, height, [[1 if data[y * width + x] >= threshold else 0 for x in range(width)] for y in range(height)]
+
+
+def pages_get(width, height, pixels):
+    """Converts pixels into pages of column bytes, the least significant bit being the top row."""
+    pages = []
+    for page in range((height + 7) // 8):
+        columns = []
+        for x in range(width):
+            byte = 0
+            for bit in range(8):
+                y = page * 8 + bit
+                if y < height and pixels[y][x]:
+                    byte |= 1 << bit
+            columns.append(byte)
+        pages.append(columns)
+    return pages
+
+
+def page_encode(columns, previous):
+    """Encodes a page as tokens, skipping the columns that are the same as in the previous frame when there is one."""
+    tokens = []
+    literal = []
+
+    def literal_flush():
+        while literal:
+            chunk = literal[:TOKEN_COUNT_MAX]
+            del literal[:TOKEN_COUNT_MAX]
+            tokens.append(TOKEN_LITERAL | (len(chunk) - 1))
+            tokens.extend(chunk)
+
+    x = 0
+    while x < len(columns):
+        count = 1
+        if previous is not None and columns[x] == previous[x]:
+            while x + count < len(columns) and count < TOKEN_COUNT_MAX and columns[x + count] == previous[x + count]:
+                count += 1
+            if count >= 2 or not literal:
+                literal_flush()
+                tokens.append(TOKEN_SKIP | (count - 1))
+                x += count
+                continue
+        count = 1
+        while x + count < len(columns) and count < TOKEN_COUNT_MAX and columns[x + count] == columns[x]:
+            count += 1
+        if columns[x] == 0 and count >= 2:
+            literal_flush()
+            tokens.append(TOKEN_ZEROS | (count - 1))
+        elif count >= 3:
+            literal_flush()
+            tokens.extend((TOKEN_REPEAT | (count - 1), columns[x]))
+        else:
+            literal.extend(columns[x:x + count])
+        x += count
+    literal_flush()
+    return tokens
+
+
+def frames_encode(frames):
+    """Encodes frames, the first one being complete so that animations can loop."""
+    data = []
+    previous = None
+    for pages in frames:
+        mask = 0
+        encoded = []
+        for page, columns in enumerate(pages):
+            if previous is not None and columns == previous[page]:
+                continue
+            mask |= 1 << page
+            encoded.extend(page_encode(columns, previous[page] if previous is not None else None))
+        data.append(mask)
+        data.extend(encoded)
+        previous = pages
+    return data
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Converts images into compressed frames for the SH1106 library.")
+    parser.add_argument("images", nargs="+", help="image files, one per frame, all of the size of the screen")
+    parser.add_argument("--name", default="image", help="name of the generated array")
+    parser.add_argument("--threshold", type=int, default=128, help="gray level from which a pixel is lit, for formats other than PBM")
+    parser.add_argument("--invert", action="store_true", help="light the pixels that would be off")
+    arguments = parser.parse_args()
+
+    frames = []
+    size = None
+    for path in arguments.images:
+        width, height, pixels = image_read(path, arguments.threshold)
+        if size is not None and size != (width, height):
+            sys.exit("%s: all frames should have the same size" % path)
+        if width > 255 or height > 64:
+            sys.exit("%s: larger than the screen" % path)
+        size = (width, height)
+        if arguments.invert:
+            pixels = [[1 - p for p in row] for row in pixels]
+        frames.append(pages_get(width, height, pixels))
+    data = frames_encode(frames)
+    length = len(data)
+    header = [size[0], (size[1] + 7) // 8, length & 0xFF, (length >> 8) & 0xFF, (length >> 16) & 0xFF, (length >> 24) & 0xFF]
+
+    raw = size[0] * ((size[1] + 7) // 8) * len(frames)
+    print("/* %d frame(s) of %dx%d pixels, %d bytes instead of %d */" % (len(frames), size[0], size[1], len(header) + length, raw))
+    print("const uint8_t %s[] PROGMEM = {" % arguments.name)
+    values = header + data
+    for start in range(0, len(values), 16):
+        print("    " + " ".join("0x%02X," % value for value in values[start:start + 16]))
+    print("};")
+
+
+if __name__ == "__main__":
+    main()
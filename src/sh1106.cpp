@@ -1,14 +1,72 @@
 /* Self header */
 #include "sh1106.h"
 
+/* Instrumentation counters, which compile to nothing unless enabled */
+#if SH1106_STATS
+#define SH1106_STATS_ADD(counter, value) (m_stats.counter += (value))
+#else
+#define SH1106_STATS_ADD(counter, value)
+#endif
+
+/* Panel configuration common to all interfaces, sent in a single transaction by setup() */
+static constexpr uint8_t sh1106_init_sequence[] = {
+    sh1106::COMMAND_DISPLAY_OFF,
+    sh1106::COMMAND_FREQUENCY_SET, 0x80,
+    sh1106::COMMAND_DISPLAY_OFFSET_SET, 0x00,
+    sh1106::COMMAND_STARTLINE_SET | 0x00,
+    sh1106::COMMAND_CHARGEPUMP_SET, 0x14,
+    sh1106::COMMAND_MEMORYMODE_SET, 0x00,
+    sh1106::COMMAND_SEGREMAP_SET | 0x01,
+    sh1106::COMMAND_SCANDIRECTION_DECREASING,
+    sh1106::COMMAND_PADS_CONFIGURATION, 0x12,
+    sh1106::COMMAND_CONTRAST_SET, 0x80,
+    sh1106::COMMAND_PRECHARGE_PERIOD_SET, 0xF1,
+    sh1106::COMMAND_VCOMH_DESELECT_LEVEL_SET, 0x40,
+    sh1106::COMMAND_ENTIREON_DISABLED,
+    sh1106::COMMAND_INVERSION_DISABLED,
+};
+
+/* Canvas the size of a single glyph, used to convert glyphs drawn by Adafruit_GFX into the page format of the panel */
+class sh1106_glyph_canvas : public Adafruit_GFX {
+   public:
+    sh1106_glyph_canvas(const int16_t w, const int16_t h, const uint8_t rotation_panel, uint8_t* const bitmap) : Adafruit_GFX(w, h), m_rotation_panel(rotation_panel), m_bitmap(bitmap) {}
+    void drawPixel(int16_t x, int16_t y, uint16_t color) {
+        if (x < 0 || y < 0 || x >= WIDTH || y >= HEIGHT || color == 0) {
+            return;
+        }
+        int16_t x_panel, y_panel, w_panel;
+        switch (m_rotation_panel) {
+            case 1: x_panel = HEIGHT - y - 1, y_panel = x, w_panel = HEIGHT; break;
+            case 2: x_panel = WIDTH - x - 1, y_panel = HEIGHT - y - 1, w_panel = WIDTH; break;
+            case 3: x_panel = y, y_panel = WIDTH - x - 1, w_panel = HEIGHT; break;
+            default: x_panel = x, y_panel = y, w_panel = WIDTH; break;
+        }
+        m_bitmap[(y_panel / 8) * w_panel + x_panel] |= 1 << (y_panel % 8);
+    }
+
+   protected:
+    const uint8_t m_rotation_panel;
+    uint8_t* const m_bitmap;
+};
+
+/* Access to the glyphs of fonts, which may be stored in program memory */
+static const GFXglyph* sh1106_font_glyph_get(const GFXfont* const font, const uint8_t index) {
+#ifdef __AVR__
+    return &(((GFXglyph*)pgm_read_word(&font->glyph))[index]);
+#else
+    return &font->glyph[index];
+#endif
+}
+
 /**
  *
  * @param[in] i2c_library
  * @param[in] i2c_address
  * @param[in] pin_res
- * @param[in] buffer A pointer to the buffer that will be used to store a local copy of the gdram, should be (m_active_width * (m_active_height / 8)) bytes.
+ * @param[in] buffer A pointer to the buffer that will be used to store a local copy of the gdram, should be (m_active_width * (m_active_height / 8)) bytes, or (m_active_width * buffer_pages) bytes.
+ * @param[in] buffer_pages The number of pages the buffer can hold, or 0 for the whole panel. With fewer pages than the panel, the screen is drawn in strips with render().
  */
-int sh1106::setup(TwoWire& i2c_library, const uint8_t i2c_address, const int pin_res, uint8_t* const buffer) {
+int sh1106::setup(TwoWire& i2c_library, const uint8_t i2c_address, const int pin_res, uint8_t* const buffer, const size_t buffer_pages) {
 
     /* Ensure i2c address is valid */
     if (i2c_address != 0x3C && i2c_address != 0x3D) {
@@ -20,46 +78,12 @@ int sh1106::setup(TwoWire& i2c_library, const uint8_t i2c_address, const int pin
     m_i2c_library = &i2c_library;
     m_i2c_address = i2c_address;
     m_buffer = buffer;
+    m_buffer_pages = (buffer_pages == 0 || buffer_pages > (m_active_height + 7) / 8) ? (m_active_height + 7) / 8 : buffer_pages;
+    m_buffer_page_first = 0;
+    m_dirty_mark_all();
 
-    /* Perform reset */
-    pinMode(pin_res, OUTPUT);
-    digitalWrite(pin_res, LOW);
-    delay(1);
-    digitalWrite(pin_res, HIGH);
-    delay(1);
-
-    /* Configure panel */
-    int res = 0;
-    res |= command_send(COMMAND_DISPLAY_OFF);
-    res |= command_send(COMMAND_FREQUENCY_SET, 0x80);
-    res |= command_send(COMMAND_MULTIPLEX_SET, m_active_height - 1);
-    res |= command_send(COMMAND_DISPLAY_OFFSET_SET, 0x00);
-    res |= command_send(COMMAND_STARTLINE_SET | 0x00);
-    res |= command_send(COMMAND_CHARGEPUMP_SET, 0x14);
-    res |= command_send(COMMAND_MEMORYMODE_SET, 0x00);
-    res |= command_send(COMMAND_SEGREMAP_SET | 0x01);
-    res |= command_send(COMMAND_SCANDIRECTION_DECREASING);
-    res |= command_send(COMMAND_PADS_CONFIGURATION, 0x12);
-    res |= command_send(COMMAND_CONTRAST_SET, 0x80);
-    res |= command_send(COMMAND_PRECHARGE_PERIOD_SET, 0xF1);
-    res |= command_send(COMMAND_VCOMH_DESELECT_LEVEL_SET, 0x40);
-    res |= command_send(COMMAND_ENTIREON_DISABLED);
-    res |= command_send(COMMAND_INVERSION_DISABLED);
-    for (size_t i = 0; i < (m_gdram_height + 7) / 8; i++) {
-        res |= command_send(COMMAND_PAGE_ADDRESS + i);
-        res |= command_send(COMMAND_COLUMN_ADDRESS_L | (2 & 0x0F));
-        res |= command_send(COMMAND_COLUMN_ADDRESS_H | (2 >> 4));
-        for (size_t j = 0; j < m_active_width; j++) {
-            res |= data_send(0x00);
-        }
-    }
-    res |= command_send(COMMAND_DISPLAY_ON);
-    if (res != 0) {
-        return -EIO;
-    }
-
-    /* Return success */
-    return 0;
+    /* Reset and configure panel */
+    return m_panel_init(pin_res);
 }
 
 /**
@@ -80,46 +104,10 @@ int sh1106::setup(TwoWire& i2c_library, const uint8_t i2c_address, const int pin
     m_i2c_library = &i2c_library;
     m_i2c_address = i2c_address;
     m_buffer = NULL;
+    m_gdram_cache_clear();
 
-    /* Perform reset */
-    pinMode(pin_res, OUTPUT);
-    digitalWrite(pin_res, LOW);
-    delay(1);
-    digitalWrite(pin_res, HIGH);
-    delay(1);
-
-    /* Configure driver */
-    int res = 0;
-    res |= command_send(COMMAND_DISPLAY_OFF);
-    res |= command_send(COMMAND_FREQUENCY_SET, 0x80);
-    res |= command_send(COMMAND_MULTIPLEX_SET, m_active_height - 1);
-    res |= command_send(COMMAND_DISPLAY_OFFSET_SET, 0x00);
-    res |= command_send(COMMAND_STARTLINE_SET | 0x00);
-    res |= command_send(COMMAND_CHARGEPUMP_SET, 0x14);
-    res |= command_send(COMMAND_MEMORYMODE_SET, 0x00);
-    res |= command_send(COMMAND_SEGREMAP_SET | 0x01);
-    res |= command_send(COMMAND_SCANDIRECTION_DECREASING);
-    res |= command_send(COMMAND_PADS_CONFIGURATION, 0x12);
-    res |= command_send(COMMAND_CONTRAST_SET, 0x80);
-    res |= command_send(COMMAND_PRECHARGE_PERIOD_SET, 0xF1);
-    res |= command_send(COMMAND_VCOMH_DESELECT_LEVEL_SET, 0x40);
-    res |= command_send(COMMAND_ENTIREON_DISABLED);
-    res |= command_send(COMMAND_INVERSION_DISABLED);
-    for (size_t i = 0; i < (m_gdram_height + 7) / 8; i++) {
-        res |= command_send(COMMAND_PAGE_ADDRESS + i);
-        res |= command_send(COMMAND_COLUMN_ADDRESS_L | (2 & 0x0F));
-        res |= command_send(COMMAND_COLUMN_ADDRESS_H | (2 >> 4));
-        for (size_t j = 0; j < m_active_width; j++) {
-            res |= data_send(0x00);
-        }
-    }
-    res |= command_send(COMMAND_DISPLAY_ON);
-    if (res != 0) {
-        return -EIO;
-    }
-
-    /* Return success */
-    return 0;
+    /* Reset and configure panel */
+    return m_panel_init(pin_res);
 }
 
 /**
@@ -129,12 +117,13 @@ int sh1106::setup(TwoWire& i2c_library, const uint8_t i2c_address, const int pin
  * @param[in] pin_cs
  * @param[in] pin_dc
  * @param[in] pin_res
- * @param[in] buffer A pointer to the buffer that will be used to store a local copy of the gdram, should be (m_active_width * (m_active_height / 8)) bytes.
+ * @param[in] buffer A pointer to the buffer that will be used to store a local copy of the gdram, should be (m_active_width * (m_active_height / 8)) bytes, or (m_active_width * buffer_pages) bytes.
+ * @param[in] buffer_pages The number of pages the buffer can hold, or 0 for the whole panel. With fewer pages than the panel, the screen is drawn in strips with render().
  */
-int sh1106::setup(SPIClass& spi_library, const int spi_speed, const int pin_cs, const int pin_dc, const int pin_res, uint8_t* const buffer) {
+int sh1106::setup(SPIClass& spi_library, const int spi_speed, const int pin_cs, const int pin_dc, const int pin_res, uint8_t* const buffer, const size_t buffer_pages) {
 
     /* Ensure spi speed is within supported range */
-    if (spi_speed > 2000000) {
+    if (spi_speed > SH1106_SPI_SPEED_MAX) {
         return -EINVAL;
     }
 
@@ -144,52 +133,82 @@ int sh1106::setup(SPIClass& spi_library, const int spi_speed, const int pin_cs,
     m_spi_settings = SPISettings(spi_speed, MSBFIRST, SPI_MODE0);
     m_pin_cs = pin_cs;
     m_pin_dc = pin_dc;
+    m_spi_dc = false;
+    m_window_depth = 0;
     m_buffer = buffer;
+    m_buffer_pages = (buffer_pages == 0 || buffer_pages > (m_active_height + 7) / 8) ? (m_active_height + 7) / 8 : buffer_pages;
+    m_buffer_page_first = 0;
+    m_dirty_mark_all();
 
     /* Configure gpios */
     digitalWrite(m_pin_cs, HIGH);
     pinMode(m_pin_cs, OUTPUT);
+    digitalWrite(m_pin_dc, LOW);
     pinMode(m_pin_dc, OUTPUT);
 
-    /* Perform reset */
-    pinMode(pin_res, OUTPUT);
-    digitalWrite(pin_res, LOW);
-    delay(1);
-    digitalWrite(pin_res, HIGH);
-    delay(1);
+    /* Reset and configure panel */
+    return m_panel_init(pin_res);
+}
 
-    /* Configure panel */
-    int res = 0;
-    res |= command_send(COMMAND_DISPLAY_OFF);
-    res |= command_send(COMMAND_FREQUENCY_SET, 0x80);
-    res |= command_send(COMMAND_MULTIPLEX_SET, m_active_height - 1);
-    res |= command_send(COMMAND_DISPLAY_OFFSET_SET, 0x00);
-    res |= command_send(COMMAND_STARTLINE_SET | 0x00);
-    res |= command_send(COMMAND_CHARGEPUMP_SET, 0x14);
-    res |= command_send(COMMAND_MEMORYMODE_SET, 0x00);
-    res |= command_send(COMMAND_SEGREMAP_SET | 0x01);
-    res |= command_send(COMMAND_SCANDIRECTION_DECREASING);
-    res |= command_send(COMMAND_PADS_CONFIGURATION, 0x12);
-    res |= command_send(COMMAND_CONTRAST_SET, 0x80);
-    res |= command_send(COMMAND_PRECHARGE_PERIOD_SET, 0xF1);
-    res |= command_send(COMMAND_VCOMH_DESELECT_LEVEL_SET, 0x40);
-    res |= command_send(COMMAND_ENTIREON_DISABLED);
-    res |= command_send(COMMAND_INVERSION_DISABLED);
-    for (size_t i = 0; i < (m_gdram_height + 7) / 8; i++) {
-        res |= command_send(COMMAND_PAGE_ADDRESS + i);
-        res |= command_send(COMMAND_COLUMN_ADDRESS_L | (2 & 0x0F));
-        res |= command_send(COMMAND_COLUMN_ADDRESS_H | (2 >> 4));
-        for (size_t j = 0; j < m_active_width; j++) {
-            res |= data_send(0x00);
-        }
-    }
-    res |= command_send(COMMAND_DISPLAY_ON);
-    if (res != 0) {
-        return -EIO;
+#if SH1106_SPI_3WIRES_GROUPS > 0
+/**
+ * Sets up the panel over a 3-wires spi bus, where the data/command bit is sent as a 9th bit in front of each byte.
+ * @param[in] spi_library
+ * @param[in] spi_speed
+ * @param[in] pin_cs
+ * @param[in] pin_res
+ * @param[in] buffer A pointer to the buffer that will be used to store a local copy of the gdram, should be (m_active_width * (m_active_height / 8)) bytes, or (m_active_width * buffer_pages) bytes.
+ * @param[in] buffer_pages The number of pages the buffer can hold, or 0 for the whole panel. With fewer pages than the panel, the screen is drawn in strips with render().
+ */
+int sh1106::setup(SPIClass& spi_library, const int spi_speed, const int pin_cs, const int pin_res, uint8_t* const buffer, const size_t buffer_pages) {
+
+    /* Ensure spi speed is within supported range */
+    if (spi_speed > SH1106_SPI_SPEED_MAX) {
+        return -EINVAL;
     }
 
-    /* Return success */
-    return 0;
+    /* Save parameters */
+    m_interface = INTERFACE_SPI_3WIRES;
+    m_spi_library = &spi_library;
+    m_spi_settings = SPISettings(spi_speed, MSBFIRST, SPI_MODE0);
+    m_pin_cs = pin_cs;
+    m_window_depth = 0;
+    m_spi_words_count = 0;
+    memset(m_spi_words, 0, sizeof(m_spi_words));
+    m_buffer = buffer;
+    m_buffer_pages = (buffer_pages == 0 || buffer_pages > (m_active_height + 7) / 8) ? (m_active_height + 7) / 8 : buffer_pages;
+    m_buffer_page_first = 0;
+    m_dirty_mark_all();
+
+    /* Configure gpios */
+    digitalWrite(m_pin_cs, HIGH);
+    pinMode(m_pin_cs, OUTPUT);
+
+    /* Reset and configure panel */
+    return m_panel_init(pin_res);
+}
+#endif
+
+/**
+ * Sets up the panel through a custom transport instead of the wire or spi libraries.
+ * @param[in] transport The transport, which receives the same commands and data as a 4-wires spi bus would.
+ * @param[in] pin_res The reset pin, or -1 if the transport takes care of resetting the panel.
+ * @param[in] buffer A pointer to the buffer that will be used to store a local copy of the gdram, should be (m_active_width * (m_active_height / 8)) bytes, or (m_active_width * buffer_pages) bytes.
+ * @param[in] buffer_pages The number of pages the buffer can hold, or 0 for the whole panel. With fewer pages than the panel, the screen is drawn in strips with render().
+ */
+int sh1106::setup(sh1106_transport& transport, const int pin_res, uint8_t* const buffer, const size_t buffer_pages) {
+
+    /* Save parameters */
+    m_interface = INTERFACE_TRANSPORT;
+    m_transport = &transport;
+    m_window_depth = 0;
+    m_buffer = buffer;
+    m_buffer_pages = (buffer_pages == 0 || buffer_pages > (m_active_height + 7) / 8) ? (m_active_height + 7) / 8 : buffer_pages;
+    m_buffer_page_first = 0;
+    m_dirty_mark_all();
+
+    /* Reset and configure panel */
+    return m_panel_init(pin_res);
 }
 
 /**
@@ -209,7 +228,8 @@ bool sh1106::detect(void) {
         }
 
         case INTERFACE_SPI_3WIRES:
-        case INTERFACE_SPI_4WIRES: {  // In SPI: there is no way to detect the device
+        case INTERFACE_SPI_4WIRES:
+        case INTERFACE_TRANSPORT: {  // In SPI or through a custom transport: there is no way to detect the device
             return true;
         }
 
@@ -219,6 +239,27 @@ bool sh1106::detect(void) {
     }
 }
 
+/**
+ * Changes which gdram columns are visible, for panels that are not wired to the middle of the 132 columns of the controller.
+ * By default the active area is centered in the gdram, which is what 128 pixels wide panels expect. Should preferably be called before setup().
+ * @param[in] offset The number of gdram columns before the first visible one.
+ * @return 0 in case of success, or a negative error code otherwise.
+ */
+int sh1106::column_offset_set(const size_t offset) {
+    if (offset + m_active_width > m_gdram_width) {
+        return -EINVAL;
+    }
+    if (m_flush_active) {
+        return -EBUSY;
+    }
+    m_blanking_h = offset;
+    m_gdram_cache_clear();
+    if (m_interface == INTERFACE_NONE) {
+        return 0;
+    }
+    return invalidate();
+}
+
 /**
  *
  * @param[in] ratio
@@ -228,7 +269,11 @@ int sh1106::brightness_set(const float ratio) {
     if (ratio < 0 || ratio > 1) {
         return -EINVAL;
     }
-    return command_send(COMMAND_CONTRAST_SET, (uint8_t)(ratio * 255));
+    int res = command_send(COMMAND_CONTRAST_SET, (uint8_t)(ratio * 255));
+    if (res == 0) {
+        m_contrast = ratio * 255;
+    }
+    return res;
 }
 
 /**
@@ -241,6 +286,49 @@ void sh1106::invertDisplay(bool i) {
     inverted_set(i);
 }
 
+/**
+ * Sets the display clock, from which the refresh rate of the panel derives, to match it with the rate frames are drawn at or to lower power.
+ * @param[in] divider The ratio the oscillator is divided by, from 1 to 16.
+ * @param[in] oscillator The oscillator frequency, from 0 (-25%) to 15 (+50%), 5 being the nominal one. setup() sets 8 with a ratio of 1.
+ * @return 0 in case of success, or a negative error code otherwise.
+ */
+int sh1106::clock_set(const uint8_t divider, const uint8_t oscillator) {
+    if (divider < 1 || divider > 16 || oscillator > 15) {
+        return -EINVAL;
+    }
+    const uint8_t frequency = (oscillator << 4) | (divider - 1);
+    int res = command_send(COMMAND_FREQUENCY_SET, frequency);
+    if (res == 0) {
+        m_frequency = frequency;
+    }
+    return res;
+}
+
+/**
+ * Sets the number of rows scanned, the refresh rate of the panel rising as it decreases. Rows past it are not shown.
+ * @param[in] ratio The number of rows, from 1 to 64.
+ * @return 0 in case of success, or a negative error code otherwise.
+ */
+int sh1106::multiplex_set(const uint8_t ratio) {
+    if (ratio < 1 || ratio > 64) {
+        return -EINVAL;
+    }
+    return command_send(COMMAND_MULTIPLEX_SET, ratio - 1);
+}
+
+/**
+ * Sets the periods pixels are charged and discharged for at each refresh, which trade brightness against power. setup() sets a precharge of 1 and a discharge of 15.
+ * @param[in] precharge The precharge period, from 1 to 15 display clocks.
+ * @param[in] discharge The discharge period, from 1 to 15 display clocks.
+ * @return 0 in case of success, or a negative error code otherwise.
+ */
+int sh1106::precharge_set(const uint8_t precharge, const uint8_t discharge) {
+    if (precharge < 1 || precharge > 15 || discharge < 1 || discharge > 15) {
+        return -EINVAL;
+    }
+    return command_send(COMMAND_PRECHARGE_PERIOD_SET, (discharge << 4) | precharge);
+}
+
 /**
  * @return
  */
@@ -248,12 +336,11 @@ int sh1106::clear(void) {
     switch (m_interface) {
 
         case INTERFACE_I2C_LIGHT: {  // For unbuffered interface, clear gdram directly
+            m_gdram_cache_clear();
             for (size_t i = 0; i < (m_gdram_height + 7) / 8; i++) {
-                command_send(COMMAND_PAGE_ADDRESS + i);
-                command_send(COMMAND_COLUMN_ADDRESS_L | (2 & 0x0F));
-                command_send(COMMAND_COLUMN_ADDRESS_H | (2 >> 4));
-                for (size_t j = 0; j < m_active_width; j++) {
-                    data_send(0x00);
+                int res = m_gdram_write(i, 0, NULL, m_gdram_width);
+                if (res < 0) {
+                    return res;
                 }
             }
             return 0;
@@ -261,8 +348,14 @@ int sh1106::clear(void) {
 
         case INTERFACE_I2C_BUFFERED:
         case INTERFACE_SPI_3WIRES:
-        case INTERFACE_SPI_4WIRES: {  // For buffered interfaces, clear local buffer
-            memset(m_buffer, 0, m_active_width * ((m_active_height + 7) / 8));
+        case INTERFACE_SPI_4WIRES:
+        case INTERFACE_TRANSPORT: {  // For buffered interfaces, clear local buffer
+            if (m_grayscale != NULL) {
+                memset(m_grayscale, 0, 2 * m_active_width * m_buffer_pages);
+                return 0;
+            }
+            memset(m_buffer, 0, m_active_width * m_buffer_pages);
+            m_dirty_mark_all();
             return 0;
         }
 
@@ -293,41 +386,33 @@ int sh1106::pixel_set(const size_t x, const size_t y, const uint16_t color) {
     switch (m_interface) {
         case INTERFACE_I2C_BUFFERED:
         case INTERFACE_SPI_3WIRES:
-        case INTERFACE_SPI_4WIRES: {
+        case INTERFACE_SPI_4WIRES:
+        case INTERFACE_TRANSPORT: {
+            if (m_grayscale != NULL) {  // One bit of the color in each bit-plane
+                for (size_t plane = 0; plane < 2; plane++) {
+                    uint8_t& destination = m_grayscale[(plane * m_buffer_pages + y_panel / 8) * m_active_width + x_panel];
+                    if ((color >> plane) & 1) {
+                        destination |= (1 << (y_panel % 8));
+                    } else {
+                        destination &= ~(1 << (y_panel % 8));
+                    }
+                }
+                break;
+            }
+            uint8_t* destination = m_buffer_page(y_panel / 8);
+            if (destination == NULL) {  // Outside of the strip being rendered
+                break;
+            }
             if (color) {
-                m_buffer[x_panel + (y_panel / 8) * m_active_width] |= (1 << (y_panel % 8));
+                destination[x_panel] |= (1 << (y_panel % 8));
             } else {
-                m_buffer[x_panel + (y_panel / 8) * m_active_width] &= ~(1 << (y_panel % 8));
+                destination[x_panel] &= ~(1 << (y_panel % 8));
             }
+            m_dirty_mark(y_panel / 8, x_panel, x_panel);
             break;
         }
         case INTERFACE_I2C_LIGHT: {
-            res = 0;
-            m_i2c_library->beginTransmission(m_i2c_address);
-            m_i2c_library->write(0x80);  // CO = 1, DC = 0
-            m_i2c_library->write(COMMAND_PAGE_ADDRESS + (y_panel / 8));
-            m_i2c_library->write(0x80);  // CO = 1, DC = 0
-            m_i2c_library->write(COMMAND_COLUMN_ADDRESS_L | ((x_panel + 2) & 0x0F));
-            m_i2c_library->write(0x80);  // CO = 1, DC = 0
-            m_i2c_library->write(COMMAND_COLUMN_ADDRESS_H | ((x_panel + 2) >> 4));
-            m_i2c_library->write(0x80);  // CO = 1, DC = 0
-            m_i2c_library->write(COMMAND_READWRITEMODIFY_BEGIN);
-            m_i2c_library->write(0x40);  // CO = 0, DC = 1
-            m_i2c_library->endTransmission(false);
-            m_i2c_library->requestFrom(m_i2c_address, 2, true);
-            m_i2c_library->read();                 // Dummy read
-            uint8_t data = m_i2c_library->read();  // Gdram data
-            m_i2c_library->beginTransmission(m_i2c_address);
-            m_i2c_library->write(0xC0);  // CO = 1, DC = 1
-            if (color) {
-                m_i2c_library->write((1 << (y_panel % 8)) | data);
-            } else {
-                m_i2c_library->write(~(1 << (y_panel % 8)) & data);
-            }
-            m_i2c_library->write(0x00);  // CO = 0, DC = 0
-            m_i2c_library->write(COMMAND_READWRITEMODIFY_END);
-            m_i2c_library->endTransmission(true);
-            break;
+            return m_gdram_span_modify(y_panel / 8, x_panel, x_panel, 1 << (y_panel % 8), color);
         }
         default: {
             return -EINVAL;
@@ -342,67 +427,162 @@ void sh1106::drawPixel(int16_t x, int16_t y, uint16_t color) {
 }
 
 /**
- *
+ * Fills a rectangle, clipped to the screen.
+ * In buffered modes, rotation is resolved once for the whole rectangle, and the rectangle is written page by page with a single mask per page, or a memset for whole pages.
+ * @param[in] x The left edge of the rectangle.
+ * @param[in] y The top edge of the rectangle.
+ * @param[in] w The width of the rectangle, can be negative to extend to the left.
+ * @param[in] h The height of the rectangle, can be negative to extend upwards.
+ * @param[in] color
+ * @return 0 in case of success, or a negative error code otherwise.
  */
-int sh1106::display(void) {
-    int res;
-    switch (m_interface) {
+int sh1106::rectangle_fill(int16_t x, int16_t y, int16_t w, int16_t h, const uint16_t color) {
+
+    /* Normalize and clip rectangle */
+    if (w < 0) {
+        x += w + 1;
+        w = -w;
+    }
+    if (h < 0) {
+        y += h + 1;
+        h = -h;
+    }
+    if (x < 0) {
+        w += x;
+        x = 0;
+    }
+    if (y < 0) {
+        h += y;
+        y = 0;
+    }
+    if (x + w > width()) w = width() - x;
+    if (y + h > height()) h = height() - y;
+    if (w <= 0 || h <= 0) {
+        return (m_interface == INTERFACE_NONE) ? -EINVAL : 0;
+    }
 
+    /* Handle rotation */
+    size_t x_panel, y_panel, w_panel, h_panel;
+    m_rectangle_rotation_handle(x, y, w, h, x_panel, y_panel, w_panel, h_panel);
+
+    /* Modify display data either in local buffer or directly in gdram */
+    switch (m_interface) {
         case INTERFACE_I2C_BUFFERED:
         case INTERFACE_SPI_3WIRES:
-        case INTERFACE_SPI_4WIRES: {
-            for (size_t i = 0, p = 0; i < (m_gdram_height + 7) / 8; i++) {
-                command_send(COMMAND_PAGE_ADDRESS + i);
-                command_send(COMMAND_COLUMN_ADDRESS_L | (2 & 0x0F));
-                command_send(COMMAND_COLUMN_ADDRESS_H | (2 >> 4));
-                for (size_t j = 0; j < m_active_width; j++) {
-                    data_send(m_buffer[p++]);
+        case INTERFACE_SPI_4WIRES:
+        case INTERFACE_TRANSPORT: {
+            if (m_grayscale != NULL) {  // Fill each bit-plane with one bit of the color
+                uint8_t* const buffer = m_buffer;
+                for (size_t plane = 0; plane < 2; plane++) {
+                    m_buffer = &m_grayscale[plane * m_buffer_pages * m_active_width];
+                    m_buffer_rectangle_fill(x_panel, y_panel, w_panel, h_panel, (color >> plane) & 1);
                 }
+                m_buffer = buffer;
+                return 0;
             }
+            m_buffer_rectangle_fill(x_panel, y_panel, w_panel, h_panel, color);
             return 0;
         }
-
-        case INTERFACE_I2C_LIGHT: {
+        case INTERFACE_I2C_LIGHT: {  // One read-modify-write run per page
+            const size_t page_first = y_panel / 8;
+            const size_t page_last = (y_panel + h_panel - 1) / 8;
+            for (size_t page = page_first; page <= page_last; page++) {
+                uint8_t mask = 0xFF;
+                if (page == page_first) mask &= 0xFF << (y_panel % 8);
+                if (page == page_last) mask &= 0xFF >> (7 - ((y_panel + h_panel - 1) % 8));
+                int res = m_gdram_span_modify(page, x_panel, x_panel + w_panel - 1, mask, color);
+                if (res < 0) {
+                    return res;
+                }
+            }
             return 0;
         }
-
         default: {
             return -EINVAL;
         }
     }
 }
+void sh1106::drawFastHLine(int16_t x, int16_t y, int16_t w, uint16_t color) {
+    rectangle_fill(x, y, w, 1, color);
+}
+void sh1106::drawFastVLine(int16_t x, int16_t y, int16_t h, uint16_t color) {
+    rectangle_fill(x, y, 1, h, color);
+}
+void sh1106::fillRect(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color) {
+    rectangle_fill(x, y, w, h, color);
+}
+void sh1106::fillScreen(uint16_t color) {
+    rectangle_fill(0, 0, width(), height(), color);
+}
 
 /**
- *
- * @param[in] command
+ * Draws a monochrome bitmap, clipped to the screen.
+ * Without rotation, each column byte of the bitmap is shifted and masked into the local buffer, and copied with memcpy when the bitmap is in page format, aligned on a page and copied.
+ * @param[in] x The left edge of the bitmap.
+ * @param[in] y The top edge of the bitmap.
+ * @param[in] bitmap The bitmap data, either in page format (for each group of 8 rows, one byte per column with the top row in the lsb) or in rows format (for each row, the columns packed msb first and padded to a byte, as used by Adafruit_GFX::drawBitmap()).
+ * @param[in] w The width of the bitmap.
+ * @param[in] h The height of the bitmap.
+ * @param[in] format The layout of the bitmap data.
+ * @param[in] operation How the bitmap is combined with what is already on screen.
+ * @return 0 in case of success, or a negative error code otherwise.
  */
-int sh1106::command_send(const uint8_t command) {
-    int res;
-    switch (m_interface) {
+int sh1106::bitmap_draw(const int16_t x, const int16_t y, const uint8_t* const bitmap, const int16_t w, const int16_t h, const enum bitmap_format format, const enum operation operation) {
+
+    /* Ensure parameters are valid */
+    if (bitmap == NULL || w < 0 || h < 0) {
+        return -EINVAL;
+    }
 
+    switch (m_interface) {
         case INTERFACE_I2C_BUFFERED:
-        case INTERFACE_I2C_LIGHT: {
-            m_i2c_library->beginTransmission(m_i2c_address);
-            m_i2c_library->write(0x00);  // CO = 0, DC = 0
-            m_i2c_library->write(command);
-            res = m_i2c_library->endTransmission(true);
-            if (res != 0) {
-                return -EIO;
+        case INTERFACE_SPI_3WIRES:
+        case INTERFACE_SPI_4WIRES:
+        case INTERFACE_TRANSPORT: {
+            if (m_grayscale != NULL) {  // Would not reach the bit-planes
+                return -EBUSY;
+            }
+
+            /* Without rotation, work on whole column bytes */
+            if (rotation == 0) {
+                m_buffer_bitmap_draw(x, y, bitmap, w, h, format, operation, 0x00);
+                return 0;
+            }
+
+            /* Otherwise, go through the rotation of each pixel */
+            for (int16_t j = 0; j < h; j++) {
+                for (int16_t i = 0; i < w; i++) {
+                    size_t x_panel, y_panel;
+                    if (x + i < 0 || y + j < 0 || m_rotation_handle(x + i, y + j, x_panel, y_panel) < 0) {
+                        continue;
+                    }
+                    uint8_t* destination = m_buffer_page(y_panel / 8);
+                    if (destination == NULL) {
+                        continue;
+                    }
+                    const uint8_t bit = (m_bitmap_byte_get(bitmap, format, w, h, i, j / 8) >> (j % 8)) & 1;
+                    m_operation_apply(destination[x_panel], bit << (y_panel % 8), 1 << (y_panel % 8), operation);
+                    m_dirty_mark(y_panel / 8, x_panel, x_panel);
+                }
             }
             return 0;
         }
 
-        case INTERFACE_SPI_4WIRES: {
-            digitalWrite(m_pin_dc, LOW);
-            m_spi_library->beginTransaction(m_spi_settings);
-            digitalWrite(m_pin_cs, LOW);
-            m_spi_library->transfer(command);
-            digitalWrite(m_pin_cs, HIGH);
-            m_spi_library->endTransaction();
+        case INTERFACE_I2C_LIGHT: {  // Without a local buffer, only operations that do not need the current pixel value are possible
+            if (operation == OPERATION_XOR) {
+                return -EINVAL;
+            }
+            for (int16_t j = 0; j < h; j++) {
+                for (int16_t i = 0; i < w; i++) {
+                    const uint8_t bit = (m_bitmap_byte_get(bitmap, format, w, h, i, j / 8) >> (j % 8)) & 1;
+                    if ((bit && operation != OPERATION_AND) || (!bit && operation != OPERATION_OR)) {
+                        pixel_set(x + i, y + j, bit);
+                    }
+                }
+            }
             return 0;
         }
 
-        case INTERFACE_SPI_3WIRES:  // TODO
         default: {
             return -EINVAL;
         }
@@ -410,39 +590,66 @@ int sh1106::command_send(const uint8_t command) {
 }
 
 /**
- *
- * @param[in] command
- * @param[in] parameter
+ * Sets or clears a batch of pixels, faster than drawing them one at a time.
+ * Rotation and interface are resolved once for the whole batch. In unbuffered mode, the pixels are gathered page by page, so that each run of modified gdram bytes is read and written back once, whatever the order of the points.
+ * @param[in] points The coordinates of the pixels, those outside of the screen being ignored.
+ * @param[in] count The number of pixels.
+ * @param[in] color
+ * @return 0 in case of success, or a negative error code otherwise.
  */
-int sh1106::command_send(const uint8_t command, const uint8_t parameter) {
-    int res;
-    switch (m_interface) {
+int sh1106::points_set(const struct point* const points, const size_t count, const uint16_t color) {
+
+    /* Ensure parameters are valid */
+    if (points == NULL && count > 0) {
+        return -EINVAL;
+    }
 
+    const struct batch_rotation batch = m_batch_rotation();
+    switch (m_interface) {
         case INTERFACE_I2C_BUFFERED:
-        case INTERFACE_I2C_LIGHT: {
-            m_i2c_library->beginTransmission(m_i2c_address);
-            m_i2c_library->write(0x00);  // CO = 0, DC = 0
-            m_i2c_library->write(command);
-            m_i2c_library->write(parameter);
-            res = m_i2c_library->endTransmission(true);
-            if (res != 0) {
-                return -EIO;
+        case INTERFACE_SPI_3WIRES:
+        case INTERFACE_SPI_4WIRES:
+        case INTERFACE_TRANSPORT: {
+            if (m_grayscale != NULL) {  // Would not reach the bit-planes
+                return -EBUSY;
+            }
+            for (size_t i = 0; i < count; i++) {
+                size_t x_panel, y_panel;
+                if (!batch.map(points[i].x, points[i].y, x_panel, y_panel)) {
+                    continue;
+                }
+                const size_t page = y_panel / 8;
+                if (page - m_buffer_page_first >= m_buffer_pages) {  // Outside of the strip being rendered
+                    continue;
+                }
+                uint8_t& destination = m_buffer[(page - m_buffer_page_first) * m_active_width + x_panel];
+                if (color) {
+                    destination |= (1 << (y_panel % 8));
+                } else {
+                    destination &= ~(1 << (y_panel % 8));
+                }
+                if (x_panel < m_dirty_min[page]) m_dirty_min[page] = x_panel;
+                if (x_panel > m_dirty_max[page]) m_dirty_max[page] = x_panel;
             }
             return 0;
         }
-
-        case INTERFACE_SPI_4WIRES: {
-            digitalWrite(m_pin_dc, LOW);
-            m_spi_library->beginTransaction(m_spi_settings);
-            digitalWrite(m_pin_cs, LOW);
-            m_spi_library->transfer(command);
-            m_spi_library->transfer(parameter);
-            digitalWrite(m_pin_cs, HIGH);
-            m_spi_library->endTransaction();
+        case INTERFACE_I2C_LIGHT: {
+            uint8_t masks[132];
+            for (size_t page = 0; page < (m_active_height + 7) / 8; page++) {
+                memset(masks, 0, sizeof(masks));
+                for (size_t i = 0; i < count; i++) {
+                    size_t x_panel, y_panel;
+                    if (batch.map(points[i].x, points[i].y, x_panel, y_panel) && y_panel / 8 == page) {
+                        masks[x_panel] |= 1 << (y_panel % 8);
+                    }
+                }
+                int res = m_gdram_masks_apply(page, masks, color);
+                if (res < 0) {
+                    return res;
+                }
+            }
             return 0;
         }
-
-        case INTERFACE_SPI_3WIRES:  // TODO
         default: {
             return -EINVAL;
         }
@@ -450,35 +657,60 @@ int sh1106::command_send(const uint8_t command, const uint8_t parameter) {
 }
 
 /**
- *
+ * Sets or clears a batch of horizontal runs of pixels, clipped to the screen.
+ * Rotation and interface are resolved once for the whole batch, and in unbuffered mode the runs are gathered page by page as with points_set().
+ * @param[in] spans The runs, those with a length of 0 or less being ignored.
+ * @param[in] count The number of runs.
+ * @param[in] color
+ * @return 0 in case of success, or a negative error code otherwise.
  */
-int sh1106::data_send(const uint8_t data) {
-    int res;
-    switch (m_interface) {
+int sh1106::spans_set(const struct span* const spans, const size_t count, const uint16_t color) {
 
+    /* Ensure parameters are valid */
+    if (spans == NULL && count > 0) {
+        return -EINVAL;
+    }
+
+    const struct batch_rotation batch = m_batch_rotation();
+    switch (m_interface) {
         case INTERFACE_I2C_BUFFERED:
-        case INTERFACE_I2C_LIGHT: {
-            m_i2c_library->beginTransmission(m_i2c_address);
-            m_i2c_library->write(0x40);  // CO = 0, DC = 1
-            m_i2c_library->write(data);
-            res = m_i2c_library->endTransmission(true);
-            if (res != 0) {
-                return -EIO;
+        case INTERFACE_SPI_3WIRES:
+        case INTERFACE_SPI_4WIRES:
+        case INTERFACE_TRANSPORT: {
+            if (m_grayscale != NULL) {  // Would not reach the bit-planes
+                return -EBUSY;
+            }
+            for (size_t i = 0; i < count; i++) {
+                size_t x_panel, y_panel, w_panel, h_panel;
+                if (m_span_rotation_handle(batch, spans[i], x_panel, y_panel, w_panel, h_panel)) {
+                    m_buffer_rectangle_fill(x_panel, y_panel, w_panel, h_panel, color);
+                }
             }
             return 0;
         }
-
-        case INTERFACE_SPI_4WIRES: {
-            digitalWrite(m_pin_dc, HIGH);
-            m_spi_library->beginTransaction(m_spi_settings);
-            digitalWrite(m_pin_cs, LOW);
-            m_spi_library->transfer(data);
-            digitalWrite(m_pin_cs, HIGH);
-            m_spi_library->endTransaction();
+        case INTERFACE_I2C_LIGHT: {
+            uint8_t masks[132];
+            for (size_t page = 0; page < (m_active_height + 7) / 8; page++) {
+                memset(masks, 0, sizeof(masks));
+                for (size_t i = 0; i < count; i++) {
+                    size_t x_panel, y_panel, w_panel, h_panel;
+                    if (!m_span_rotation_handle(batch, spans[i], x_panel, y_panel, w_panel, h_panel) || y_panel / 8 > page || (y_panel + h_panel - 1) / 8 < page) {
+                        continue;
+                    }
+                    uint8_t mask = 0xFF;
+                    if (y_panel / 8 == page) mask &= 0xFF << (y_panel % 8);
+                    if ((y_panel + h_panel - 1) / 8 == page) mask &= 0xFF >> (7 - ((y_panel + h_panel - 1) % 8));
+                    for (size_t column = x_panel; column < x_panel + w_panel; column++) {
+                        masks[column] |= mask;
+                    }
+                }
+                int res = m_gdram_masks_apply(page, masks, color);
+                if (res < 0) {
+                    return res;
+                }
+            }
             return 0;
         }
-
-        case INTERFACE_SPI_3WIRES:  // TODO
         default: {
             return -EINVAL;
         }
@@ -486,43 +718,2032 @@ int sh1106::data_send(const uint8_t data) {
 }
 
 /**
- *
+ * Sets or clears the pixels of packed scanlines, clipped to the screen, leaving the others untouched.
+ * Rotation and interface are resolved once for the whole batch. Without rotation, whole column bytes are written to the local buffer, and in unbuffered mode the pixels are gathered page by page as with points_set().
+ * @param[in] x The left edge of the scanlines.
+ * @param[in] y The top scanline.
+ * @param[in] bits For each scanline, the pixels to modify packed msb first, each scanline padded to a byte.
+ * @param[in] w The number of pixels in each scanline.
+ * @param[in] h The number of scanlines.
+ * @param[in] color
+ * @return 0 in case of success, or a negative error code otherwise.
  */
-int sh1106::data_send(uint8_t* const data, const size_t length) {
-    int res;
-    switch (m_interface) {
+int sh1106::scanlines_draw(const int16_t x, const int16_t y, const uint8_t* const bits, const int16_t w, const int16_t h, const uint16_t color) {
+
+    /* Ensure parameters are valid */
+    if (bits == NULL || w < 0 || h < 0) {
+        return -EINVAL;
+    }
 
+    const struct batch_rotation batch = m_batch_rotation();
+    const size_t stride = (w + 7) / 8;
+    switch (m_interface) {
         case INTERFACE_I2C_BUFFERED:
-        case INTERFACE_I2C_LIGHT: {
-            for (size_t i = 0; i < length;) {
-                m_i2c_library->beginTransmission(m_i2c_address);
-                m_i2c_library->write(0x40);  // CO = 0, DC = 1
-                i += m_i2c_library->write(&data[i], length - i);
-                res = m_i2c_library->endTransmission(true);
-                if (res != 0) {
-                    return -EIO;
+        case INTERFACE_SPI_3WIRES:
+        case INTERFACE_SPI_4WIRES:
+        case INTERFACE_TRANSPORT: {
+            if (m_grayscale != NULL) {  // Would not reach the bit-planes
+                return -EBUSY;
+            }
+
+            /* Without rotation, work on whole column bytes */
+            if (rotation == 0) {
+                m_buffer_bitmap_draw(x, y, bits, w, h, BITMAP_FORMAT_ROWS, color ? OPERATION_OR : OPERATION_AND, color ? 0x00 : 0xFF);
+                return 0;
+            }
+
+            /* Otherwise, go through the pixels set in each scanline */
+            for (int16_t j = 0; j < h; j++) {
+                for (int16_t i = 0; i < w; i++) {
+                    size_t x_panel, y_panel;
+                    if (!(bits[j * stride + i / 8] & (0x80 >> (i % 8))) || !batch.map(x + i, y + j, x_panel, y_panel)) {
+                        continue;
+                    }
+                    const size_t page = y_panel / 8;
+                    if (page - m_buffer_page_first >= m_buffer_pages) {  // Outside of the strip being rendered
+                        continue;
+                    }
+                    uint8_t& destination = m_buffer[(page - m_buffer_page_first) * m_active_width + x_panel];
+                    if (color) {
+                        destination |= (1 << (y_panel % 8));
+                    } else {
+                        destination &= ~(1 << (y_panel % 8));
+                    }
+                    if (x_panel < m_dirty_min[page]) m_dirty_min[page] = x_panel;
+                    if (x_panel > m_dirty_max[page]) m_dirty_max[page] = x_panel;
                 }
             }
             return 0;
         }
-
-        case INTERFACE_SPI_4WIRES: {
-            digitalWrite(m_pin_dc, HIGH);
-            m_spi_library->beginTransaction(m_spi_settings);
-            digitalWrite(m_pin_cs, LOW);
-            m_spi_library->transfer(data, length);
-            digitalWrite(m_pin_cs, HIGH);
-            m_spi_library->endTransaction();
+        case INTERFACE_I2C_LIGHT: {
+            uint8_t masks[132];
+            for (size_t page = 0; page < (m_active_height + 7) / 8; page++) {
+                memset(masks, 0, sizeof(masks));
+                for (int16_t j = 0; j < h; j++) {
+                    for (int16_t i = 0; i < w; i++) {
+                        size_t x_panel, y_panel;
+                        if ((bits[j * stride + i / 8] & (0x80 >> (i % 8))) && batch.map(x + i, y + j, x_panel, y_panel) && y_panel / 8 == page) {
+                            masks[x_panel] |= 1 << (y_panel % 8);
+                        }
+                    }
+                }
+                int res = m_gdram_masks_apply(page, masks, color);
+                if (res < 0) {
+                    return res;
+                }
+            }
             return 0;
         }
-
-        case INTERFACE_SPI_3WIRES:  // TODO
         default: {
             return -EINVAL;
         }
     }
 }
 
+/**
+ * Sends a compressed image straight to the gdram, without going through the local buffer.
+ * @param[in] image The image, as produced by extras/image_convert.py, in program memory. Only the first frame of an animation is drawn.
+ * @return 0 in case of success, or a negative error code otherwise.
+ */
+int sh1106::image_draw(const uint8_t* const image) {
+    size_t position = 0;
+    int res = animation_play(image, position);
+    return (res < 0) ? res : 0;
+}
+
+/**
+ * Sends the next frame of a compressed animation straight to the gdram, without going through the local buffer, so it also works in unbuffered mode.
+ * The animation starts with a header of six bytes: width, number of pages, and the length of the frames that follow (32-bit, little endian). Each frame then starts with a byte where each bit set is a page that changed since the previous frame.
+ * Each changed page is a sequence of tokens covering its columns, whose two high bits are the kind of token, and six low bits the number of columns minus one:
+ * 0b00: columns unchanged, 0b01: the next byte repeated, 0b10: that many literal bytes follow, 0b11: zeros.
+ * @param[in] animation The animation, as produced by extras/image_convert.py, in program memory.
+ * @param[in,out] position Where the next frame starts in the animation, should be 0 to play the first frame, and is reset to 0 after the last one.
+ * @return 1 if more frames follow, 0 if the last frame was played, or a negative error code otherwise.
+ */
+int sh1106::animation_play(const uint8_t* const animation, size_t& position) {
+    int res;
+
+    /* Ensure parameters are valid */
+    if (animation == NULL || pgm_read_byte(&animation[0]) != m_active_width || pgm_read_byte(&animation[1]) != (m_active_height + 7) / 8) {
+        return -EINVAL;
+    }
+    const uint32_t length = pgm_read_byte(&animation[2]) | ((uint32_t)pgm_read_byte(&animation[3]) << 8) | ((uint32_t)pgm_read_byte(&animation[4]) << 16) | ((uint32_t)pgm_read_byte(&animation[5]) << 24);
+    if (length == 0 || position >= 6 + length) {
+        return -EINVAL;
+    }
+
+    switch (m_interface) {
+        case INTERFACE_I2C_BUFFERED:
+        case INTERFACE_SPI_3WIRES:
+        case INTERFACE_SPI_4WIRES:
+        case INTERFACE_TRANSPORT:
+        case INTERFACE_I2C_LIGHT: {
+            if (m_flush_active || m_frames[0] != NULL || m_grayscale != NULL) {
+                return -EBUSY;
+            }
+            m_gdram_cache_clear();
+
+            /* Decode each changed page into runs of bytes sent as they fill up */
+            const uint8_t* source = &animation[(position == 0) ? 6 : position];
+            const uint8_t pages = pgm_read_byte(source++);
+            m_window_open();
+            res = 0;
+            for (size_t page = 0; page < (m_active_height + 7) / 8 && res >= 0; page++) {
+                if (!(pages & (1 << page))) {
+                    continue;
+                }
+                uint8_t run[32];
+                size_t run_length = 0, column = 0;
+                while (column < m_active_width && res >= 0) {
+                    const uint8_t token = pgm_read_byte(source++);
+                    size_t count = (token & 0x3F) + 1;
+                    if (column + count > m_active_width) {
+                        res = -EINVAL;
+                        break;
+                    }
+                    if ((token >> 6) == 0) {
+                        res = m_image_run_send(page, column - run_length, run, run_length);
+                        run_length = 0;
+                        column += count;
+                        continue;
+                    }
+                    const uint8_t repeated = ((token >> 6) == 1) ? pgm_read_byte(source++) : 0x00;
+                    for (; count > 0 && res >= 0; count--) {
+                        run[run_length++] = ((token >> 6) == 2) ? pgm_read_byte(source++) : repeated;
+                        column++;
+                        if (run_length == sizeof(run)) {
+                            res = m_image_run_send(page, column - run_length, run, run_length);
+                            run_length = 0;
+                        }
+                    }
+                }
+                if (res >= 0) {
+                    res = m_image_run_send(page, column - run_length, run, run_length);
+                }
+            }
+            m_window_close();
+            if (res < 0) {
+                return res;
+            }
+
+            /* Move on to the next frame, or back to the first one */
+            position = source - animation;
+            if (position >= 6 + length) {
+                position = 0;
+                return 0;
+            }
+            return 1;
+        }
+
+        default: {
+            return -EINVAL;
+        }
+    }
+}
+
+/**
+ * Sends the parts of the local buffer that changed to the gdram.
+ * Nothing is sent if nothing changed, or if a frame was sent too recently for the rate set with frame_rate_set().
+ * @return 0 in case of success, 1 if the transfer was deferred by frame_rate_set() and display() should be called again later, or a negative error code otherwise.
+ */
+int sh1106::display(void) {
+    int res = 0;
+    switch (m_interface) {
+
+        case INTERFACE_I2C_BUFFERED:
+        case INTERFACE_SPI_3WIRES:
+        case INTERFACE_SPI_4WIRES:
+        case INTERFACE_TRANSPORT: {
+
+            /* Complete any flush in progress, then send what changed since it started */
+            if (m_grayscale != NULL) {  // The panel is then fed by grayscale_poll()
+                return -EBUSY;
+            }
+
+            /* Unless the buffer only holds a strip, let changes accumulate until there are some and the next transfer is due */
+            if (!m_flush_active && m_buffer_pages >= (m_active_height + 7) / 8) {
+                bool dirty = false;
+                for (size_t page = 0; page < (m_active_height + 7) / 8; page++) {
+                    if (m_dirty_min[page] <= m_dirty_max[page]) {
+                        dirty = true;
+                        break;
+                    }
+                }
+                if (!dirty) {
+                    return 0;
+                }
+                if (m_frame_interval != 0 && micros() - m_frame_last < m_frame_interval) {
+                    return 1;
+                }
+                m_frame_last = micros();
+            }
+            const bool restart = m_flush_active;
+            m_window_open();
+            for (int pass = restart ? 0 : 1; pass < 2 && res >= 0; pass++) {
+                if (!m_flush_active) {
+                    res = display_begin();
+                }
+                while (res >= 0 && (res = m_flush_step(false)) > 0) {
+                }
+            }
+            m_window_close();
+            return res;
+        }
+
+        case INTERFACE_I2C_LIGHT: {
+            return 0;
+        }
+
+        default: {
+            return -EINVAL;
+        }
+    }
+}
+
+/**
+ * Starts sending the parts of the local buffer that changed, without blocking.
+ * The transfer is then carried out by calling display_poll() until it reports completion, which lets the application keep running between chunks.
+ * @return 0 in case of success, or a negative error code otherwise.
+ */
+int sh1106::display_begin(void) {
+    switch (m_interface) {
+
+        case INTERFACE_I2C_BUFFERED:
+        case INTERFACE_SPI_3WIRES:
+        case INTERFACE_SPI_4WIRES:
+        case INTERFACE_TRANSPORT: {
+            if (m_flush_active || m_grayscale != NULL) {
+                return -EBUSY;
+            }
+            m_flush_active = true;
+            m_flush_full = false;
+            m_flush_buffer = m_buffer;
+            m_flush_page_next = 0;
+            m_flush_column = 0;
+            m_flush_column_end = 0;
+            m_flush_shadow_validates = !m_shadow_valid;
+#if SH1106_STATS
+            m_stats_frame_begin();
+#endif
+            return 0;
+        }
+
+        case INTERFACE_I2C_LIGHT: {
+            return 0;
+        }
+
+        default: {
+            return -EINVAL;
+        }
+    }
+}
+
+/**
+ * Sends the next chunk of a transfer started with display_begin().
+ * Each call performs at most one i2c transaction, or sends at most one page in spi.
+ * @return 1 if the transfer is still in progress, 0 if it is complete, or a negative error code otherwise.
+ */
+int sh1106::display_poll(void) {
+    return m_flush_step(true);
+}
+
+/**
+ * Sends the next run of the transfer in progress.
+ * @param[in] bounded Whether to limit the run to a single i2c transaction.
+ * @return 1 if the transfer is still in progress, 0 if it is complete, or a negative error code otherwise.
+ */
+int sh1106::m_flush_step(const bool bounded) {
+    int res;
+    switch (m_interface) {
+
+        case INTERFACE_I2C_BUFFERED:
+        case INTERFACE_SPI_3WIRES:
+        case INTERFACE_SPI_4WIRES:
+        case INTERFACE_TRANSPORT: {
+            if (!m_flush_active) {
+                return 0;
+            }
+            for (;;) {
+
+                /* Send the next run of the range being flushed */
+                size_t start, stop;
+                if (m_flush_column < m_flush_column_end && m_run_find(m_flush_page, m_flush_column, m_flush_column_end, start, stop)) {
+                    if (bounded && m_interface == INTERFACE_I2C_BUFFERED && stop - start > SH1106_I2C_BUFFER_LENGTH - 7) {
+                        stop = start + SH1106_I2C_BUFFER_LENGTH - 7;
+                    }
+                    const uint8_t* buffer = &m_flush_buffer[(m_flush_page - m_buffer_page_first) * m_active_width];
+#if SH1106_STATS
+                    const uint32_t time_start = micros();
+#endif
+                    m_window_open();
+                    res = m_gdram_write(m_flush_page, m_blanking_h + start, &buffer[start], stop - start);
+                    m_window_close();
+#if SH1106_STATS
+                    m_stats.page_us[m_flush_page] += micros() - time_start;
+#endif
+                    if (res < 0) {
+                        if (!m_flush_full) {
+                            m_dirty_mark(m_flush_page, start, m_flush_column_end - 1);
+                        }
+                        m_flush_active = false;
+                        return res;
+                    }
+                    if (m_shadow != NULL) {
+                        memcpy(&m_shadow[m_flush_page * m_active_width + start], &buffer[start], stop - start);
+                    }
+                    m_flush_column = stop;
+                    return 1;
+                }
+
+                /* Move on to the next dirty page */
+                size_t page = m_flush_page_next;
+                while (page < (m_active_height + 7) / 8 && !m_flush_full && (m_dirty_min[page] > m_dirty_max[page] || m_buffer_page(page) == NULL)) {
+                    page++;
+                }
+                if (page >= (m_active_height + 7) / 8) {
+                    m_flush_active = false;
+                    if (m_shadow != NULL && m_flush_shadow_validates) {
+                        m_shadow_valid = true;
+                    }
+#if SH1106_STATS
+                    m_stats.frames++;
+                    m_stats.frame_bytes = m_stats.bytes_command + m_stats.bytes_data - m_stats_frame_bytes;
+                    m_stats.frame_transactions = m_stats.transactions - m_stats_frame_transactions;
+                    m_stats.frame_us = micros() - m_stats_frame_start;
+#endif
+                    return 0;
+                }
+                m_flush_page = page;
+                m_flush_page_next = page + 1;
+                if (m_flush_full) {
+                    m_flush_column = 0;
+                    m_flush_column_end = m_active_width;
+                } else {
+                    m_flush_column = m_dirty_min[page];
+                    m_flush_column_end = m_dirty_max[page] + 1;
+                    m_dirty_min[page] = 0xFF;
+                    m_dirty_max[page] = 0;
+                }
+            }
+        }
+
+        case INTERFACE_I2C_LIGHT: {
+            return 0;
+        }
+
+        default: {
+            return -EINVAL;
+        }
+    }
+}
+
+/**
+ * Draws the whole screen with a buffer that only holds a strip of pages.
+ * For each strip, the buffer is cleared, the callback draws the whole screen as usual, only what falls within the strip is kept, and the strip is sent with burst writes.
+ * @param[in] callback The function drawing the screen, called once per strip.
+ * @param[in] context A pointer passed to the callback.
+ * @return 0 in case of success, or a negative error code otherwise.
+ */
+int sh1106::render(void (*callback)(sh1106& display, void* context), void* context) {
+    int res;
+
+    /* Ensure parameters are valid */
+    if (callback == NULL) {
+        return -EINVAL;
+    }
+
+    switch (m_interface) {
+
+        case INTERFACE_I2C_BUFFERED:
+        case INTERFACE_SPI_3WIRES:
+        case INTERFACE_SPI_4WIRES:
+        case INTERFACE_TRANSPORT: {
+            for (size_t page = 0; page < (m_active_height + 7) / 8; page += m_buffer_pages) {
+                m_buffer_page_first = page;
+                memset(m_buffer, 0, m_active_width * m_buffer_pages);
+                for (size_t i = page; i < page + m_buffer_pages && i < (m_active_height + 7) / 8; i++) {
+                    m_dirty_mark(i, 0, m_active_width - 1);
+                }
+                callback(*this, context);
+                res = display();
+                if (res < 0) {
+                    m_buffer_page_first = 0;
+                    return res;
+                }
+            }
+            m_buffer_page_first = 0;
+            return 0;
+        }
+
+        default: {
+            return -EINVAL;
+        }
+    }
+}
+
+/**
+ * Caps the rate at which display() sends frames, to leave the bus to other peripherals.
+ * Calls to display() that come too soon after the last transfer return 1 without sending anything, and what was drawn in between is sent together by a later call, so display() should be called again until it returns 0.
+ * @param[in] fps The highest number of frames per second, or 0 for no limit.
+ * @return 0 in case of success, or a negative error code otherwise.
+ */
+int sh1106::frame_rate_set(const float fps) {
+    if (fps < 0) {
+        return -EINVAL;
+    }
+    m_frame_interval = (fps > 0) ? (uint32_t)(1000000 / fps) : 0;
+    m_frame_last = micros() - m_frame_interval;  // So the next transfer is not deferred
+    return 0;
+}
+
+/**
+ * Provides two more buffers to draw and send frames from different threads or cores without tearing.
+ * The three buffers rotate between the frame being drawn, the latest completed frame, and the frame being sent. Handing frames over is lock-free: frame_submit() and frame_flush() only exchange a buffer index atomically.
+ * @param[in] buffer_second A pointer to a buffer of the same size as the one given to setup(), or NULL to stop using several buffers.
+ * @param[in] buffer_third A pointer to a buffer of the same size as the one given to setup(), or NULL to stop using several buffers.
+ * @return 0 in case of success, or a negative error code otherwise.
+ */
+int sh1106::frames_set(uint8_t* const buffer_second, uint8_t* const buffer_third) {
+    switch (m_interface) {
+
+        case INTERFACE_I2C_BUFFERED:
+        case INTERFACE_SPI_3WIRES:
+        case INTERFACE_SPI_4WIRES:
+        case INTERFACE_TRANSPORT: {
+            if (m_buffer_pages < (m_active_height + 7) / 8) {  // Not possible while rendering strips
+                return -EINVAL;
+            }
+            if (buffer_second == NULL || buffer_third == NULL) {
+                m_frames[0] = m_frames[1] = m_frames[2] = NULL;
+                return 0;
+            }
+            m_frames[0] = m_buffer;
+            m_frames[1] = buffer_second;
+            m_frames[2] = buffer_third;
+            m_frame_render = 0;
+            m_frame_flush = 1;
+            m_frame_ready = 2;
+            memset(buffer_second, 0, m_active_width * m_buffer_pages);
+            memset(buffer_third, 0, m_active_width * m_buffer_pages);
+            return 0;
+        }
+
+        default: {
+            return -EINVAL;
+        }
+    }
+}
+
+/**
+ * Publishes the frame that was drawn in the local buffer, to be sent by frame_flush(), and switches drawing to another buffer.
+ * The new buffer holds an older frame, so the screen should be redrawn completely.
+ * @return 1 if the previously submitted frame was replaced before being sent, 0 if it was sent, or a negative error code otherwise.
+ */
+int sh1106::frame_submit(void) {
+    if (m_frames[0] == NULL) {
+        return -EINVAL;
+    }
+    const uint8_t previous = __atomic_exchange_n(&m_frame_ready, m_frame_render | FRAME_READY_NEW, __ATOMIC_ACQ_REL);
+    m_frame_render = previous & ~FRAME_READY_NEW;
+    m_buffer = m_frames[m_frame_render];
+    return (previous & FRAME_READY_NEW) ? 1 : 0;
+}
+
+/**
+ * Sends the latest frame published with frame_submit(), if any.
+ * Frames that were replaced before this is called are skipped. Can be called from another thread or core than the one drawing.
+ * @return 1 if a frame was sent, 0 if there was no new frame, or a negative error code otherwise.
+ */
+int sh1106::frame_flush(void) {
+    int res;
+    if (m_frames[0] == NULL) {
+        return -EINVAL;
+    }
+
+    /* Take the latest frame, if there is a new one */
+    if ((__atomic_load_n(&m_frame_ready, __ATOMIC_ACQUIRE) & FRAME_READY_NEW) == 0) {
+        return 0;
+    }
+    const uint8_t ready = __atomic_exchange_n(&m_frame_ready, m_frame_flush, __ATOMIC_ACQ_REL);
+    m_frame_flush = ready & ~FRAME_READY_NEW;
+
+    /* Send it entirely, or only what changed if there is a shadow buffer */
+    m_flush_start(m_frames[m_frame_flush]);
+    m_window_open();
+    while ((res = m_flush_step(false)) > 0) {
+    }
+    m_window_close();
+    if (res < 0) {
+        m_shadow_valid = false;
+        return res;
+    }
+    return 1;
+}
+
+/**
+ * Scrolls a band of pages left by one column (in panel orientation), leaving an empty column on the right for the next one to be drawn.
+ * Meant for tickers: the band is moved within the local buffer, so only the newly appearing column has to be drawn before the next call to display().
+ * @param[in] page The first page of the band.
+ * @param[in] pages The number of pages of the band.
+ * @return 0 in case of success, or a negative error code otherwise.
+ */
+int sh1106::scroll_left(const size_t page, const size_t pages) {
+    switch (m_interface) {
+
+        case INTERFACE_I2C_BUFFERED:
+        case INTERFACE_SPI_3WIRES:
+        case INTERFACE_SPI_4WIRES:
+        case INTERFACE_TRANSPORT: {
+            if (m_grayscale != NULL) {  // Would not reach the bit-planes
+                return -EBUSY;
+            }
+            if (pages == 0 || page + pages > (m_active_height + 7) / 8) {
+                return -EINVAL;
+            }
+            for (size_t i = page; i < page + pages; i++) {
+                if (m_buffer_page(i) == NULL) {
+                    return -EINVAL;
+                }
+            }
+            for (size_t i = page; i < page + pages; i++) {
+                uint8_t* destination = m_buffer_page(i);
+                memmove(destination, &destination[1], m_active_width - 1);
+                destination[m_active_width - 1] = 0x00;
+                m_dirty_mark(i, 0, m_active_width - 1);
+            }
+            return 0;
+        }
+
+        default: {
+            return -EINVAL;
+        }
+    }
+}
+
+/**
+ * Scrolls the content of the screen up by one page (8 rows, in panel orientation), leaving an empty page at the bottom.
+ * Instead of sending the whole screen again, the gdram start line is moved by one page, and only the page that appears at the bottom is cleared in the gdram.
+ * @return 0 in case of success, or a negative error code otherwise.
+ */
+int sh1106::scroll_up(void) {
+    int res;
+    const size_t pages = (m_active_height + 7) / 8;
+    switch (m_interface) {
+
+        case INTERFACE_I2C_BUFFERED:
+        case INTERFACE_SPI_3WIRES:
+        case INTERFACE_SPI_4WIRES:
+        case INTERFACE_TRANSPORT:
+        case INTERFACE_I2C_LIGHT: {
+            if (m_flush_active || m_frames[0] != NULL || m_grayscale != NULL) {
+                return -EBUSY;
+            }
+
+            /* Clear the gdram page that will appear at the bottom, then move the start line over it */
+            res = m_gdram_write(pages, 0, NULL, m_gdram_width);
+            if (res < 0) {
+                return res;
+            }
+            m_scroll_pages = (m_scroll_pages + 1) % (m_gdram_height / 8);
+            res = command_send(COMMAND_STARTLINE_SET | (m_scroll_pages * 8));
+            if (res < 0) {
+                return res;
+            }
+
+            /* Without a local buffer, forget the cached gdram bytes as their pages moved */
+            if (m_interface == INTERFACE_I2C_LIGHT) {
+                m_gdram_cache_clear();
+                return 0;
+            }
+
+            /* Move the local buffer, its shadow and its dirty ranges along, the strips being rendered are redrawn anyway */
+            if (m_buffer_pages < pages) {
+                return 0;
+            }
+            memmove(m_buffer, &m_buffer[m_active_width], m_active_width * (pages - 1));
+            memset(&m_buffer[m_active_width * (pages - 1)], 0, m_active_width);
+            if (m_shadow != NULL) {
+                memmove(m_shadow, &m_shadow[m_active_width], m_active_width * (pages - 1));
+                memset(&m_shadow[m_active_width * (pages - 1)], 0, m_active_width);
+            }
+            for (size_t i = 0; i + 1 < pages; i++) {
+                m_dirty_min[i] = m_dirty_min[i + 1];
+                m_dirty_max[i] = m_dirty_max[i + 1];
+            }
+            m_dirty_min[pages - 1] = 0xFF;
+            m_dirty_max[pages - 1] = 0;
+            return 0;
+        }
+
+        default: {
+            return -EINVAL;
+        }
+    }
+}
+
+/**
+ * Enters or leaves a 4-level grayscale mode, where two bit-planes are shown in turn fast enough for the eye to blend them.
+ * In each cycle, the high bit-plane is shown either twice as long as the low one, or as long but at twice the contrast. The bit-planes are sent by grayscale_poll(), which should be called as often as possible, and only the bytes that differ between them are sent if there is a shadow buffer.
+ * While in grayscale mode, drawPixel(), pixel_set(), rectangle_fill(), clear() and the Adafruit_GFX functions built on them take colors from 0 (off) to 3 (fully lit) and draw into the bit-planes. Drawing functions that would bypass the bit-planes (bitmap_draw(), points_set(), spans_set(), scanlines_draw(), image_draw(), animation_play(), scroll_up() and scroll_left()) return -EBUSY instead.
+ * @param[in] planes A pointer to a buffer twice the size of the local buffer, which is cleared, or NULL to leave grayscale mode.
+ * @param[in] slot_us The time each bit-plane is shown for, in microseconds, or for the high one, half the time it is shown for. The transfer of a bit-plane should fit in it, which grayscale_timing_get() tells.
+ * @param[in] contrast_modulated Whether to weight the bit-planes by contrast rather than by time, which needs one slot less per cycle but relies on the contrast response of the panel.
+ * @param[in] frequency Optionally, the display clock setting (COMMAND_FREQUENCY_SET) to use while in grayscale mode, such as 0xF0 for the fastest oscillator, which reduces flicker. 0 keeps the current one.
+ * @return 0 in case of success, or a negative error code otherwise.
+ */
+int sh1106::grayscale_set(uint8_t* const planes, const uint32_t slot_us, const bool contrast_modulated, const uint8_t frequency) {
+    int res;
+    switch (m_interface) {
+
+        case INTERFACE_I2C_BUFFERED:
+        case INTERFACE_SPI_3WIRES:
+        case INTERFACE_SPI_4WIRES:
+        case INTERFACE_TRANSPORT: {
+
+            /* Ensure parameters are valid */
+            if (m_buffer_pages < (m_active_height + 7) / 8 || m_frames[0] != NULL) {  // Not possible while rendering strips or rotating frames
+                return -EINVAL;
+            }
+            if (planes != NULL && slot_us == 0) {
+                return -EINVAL;
+            }
+
+            /* Complete the transfer in progress, and restore the settings of monochrome mode */
+            while ((res = m_flush_step(false)) > 0) {
+            }
+            if (res < 0) {
+                return res;
+            }
+            if (m_grayscale != NULL) {
+                const uint8_t commands[] = {COMMAND_CONTRAST_SET, m_contrast, COMMAND_FREQUENCY_SET, m_frequency};
+                m_grayscale = NULL;
+                res = commands_send(commands, sizeof(commands));
+                if (res < 0) {
+                    return res;
+                }
+                invalidate();
+            }
+            if (planes == NULL) {
+                return 0;
+            }
+
+            /* Start showing the high bit-plane */
+            if (frequency != 0) {
+                res = command_send(COMMAND_FREQUENCY_SET, frequency);
+                if (res < 0) {
+                    return res;
+                }
+            }
+            memset(planes, 0, 2 * m_active_width * m_buffer_pages);
+            m_grayscale = planes;
+            m_grayscale_slot_us = slot_us;
+            m_grayscale_contrast = contrast_modulated;
+            m_grayscale_slot = 0;
+            m_grayscale_slot_start = m_grayscale_cycle_start = m_grayscale_transfer_start = micros();
+            m_grayscale_timing = {};
+            m_flush_start(&m_grayscale[m_active_width * m_buffer_pages]);
+            return 0;
+        }
+
+        default: {
+            return -EINVAL;
+        }
+    }
+}
+
+/**
+ * Keeps the grayscale cycle going: sends the next chunk of the bit-plane being transferred, or moves on to the next slot when the current one is over.
+ * Each call performs at most one i2c transaction, or sends at most one page in spi.
+ * @return 1 if a bit-plane is being transferred, 0 if waiting for the next slot, or a negative error code otherwise.
+ */
+int sh1106::grayscale_poll(void) {
+    int res;
+    if (m_grayscale == NULL) {
+        return -EINVAL;
+    }
+
+    /* Carry on with the transfer of the bit-plane of the current slot */
+    if (m_flush_active) {
+        res = m_flush_step(true);
+        if (res != 0) {
+            return res;
+        }
+        const uint32_t now = micros();
+        m_grayscale_timing.transfer_us = now - m_grayscale_transfer_start;
+        if (now - m_grayscale_slot_start > m_grayscale_slot_us) {
+            m_grayscale_timing.overruns++;
+        }
+        if (m_grayscale_contrast) {
+            return command_send(COMMAND_CONTRAST_SET, (m_grayscale_slot == 0) ? m_contrast : m_contrast / 2);
+        }
+        return 0;
+    }
+
+    /* Wait for the current slot to be over, keeping the cadence unless already a slot late */
+    const uint32_t now = micros();
+    if (now - m_grayscale_slot_start < m_grayscale_slot_us) {
+        return 0;
+    }
+    m_grayscale_slot_start = (now - m_grayscale_slot_start < 2 * m_grayscale_slot_us) ? m_grayscale_slot_start + m_grayscale_slot_us : now;
+
+    /* Move on to the next slot, the high bit-plane being shown in the first two when weighted by time */
+    const size_t slots = m_grayscale_contrast ? 2 : 3;
+    m_grayscale_slot = (m_grayscale_slot + 1) % slots;
+    if (m_grayscale_slot == 0) {
+        m_grayscale_timing.cycles++;
+        m_grayscale_timing.cycle_us = now - m_grayscale_cycle_start;
+        m_grayscale_cycle_start = now;
+    }
+    if (m_grayscale_slot == 1 && !m_grayscale_contrast) {  // Same bit-plane, nothing to send
+        return 0;
+    }
+    const size_t plane = (m_grayscale_slot == 0) ? 1 : 0;
+    m_grayscale_transfer_start = now;
+    m_flush_start(&m_grayscale[plane * m_active_width * m_buffer_pages]);
+    return 1;
+}
+
+/**
+ * Tells how the grayscale cycle keeps up, which shows whether the bus is fast enough for the slot duration.
+ * @return The timing, which keeps being updated.
+ */
+const struct sh1106::grayscale_timing& sh1106::grayscale_timing_get(void) const {
+    return m_grayscale_timing;
+}
+
+/**
+ * Turns the text output into a console, where starting a line past the bottom of the screen scrolls it up instead of drawing off screen.
+ * Scrolling is done with scroll_up(), so this requires the default font at a text size of 1, without rotation, and the cursor on a page boundary.
+ * @param[in] enabled
+ * @return 0 in case of success, or a negative error code otherwise.
+ */
+int sh1106::console_set(const bool enabled) {
+    if (m_interface == INTERFACE_NONE) {
+        return -EINVAL;
+    }
+    m_console = enabled;
+    return 0;
+}
+
+/**
+ * Provides a buffer in which glyphs are kept once converted to the page format of the panel, for the font, text size and rotation they were drawn with.
+ * Text is then drawn by copying whole column bytes into the local buffer instead of setting each pixel, which is much faster, especially when the text is aligned on pages.
+ * When the cache is full, it is emptied and filled again with the glyphs that are drawn next.
+ * @param[in] cache A pointer to the buffer, or NULL to stop using one. A few hundred bytes are used to index SH1106_GLYPH_CACHE_ENTRIES glyphs.
+ * @param[in] size The size of the buffer in bytes.
+ * @return 0 in case of success, or a negative error code otherwise.
+ */
+int sh1106::glyph_cache_set(uint8_t* const cache, const size_t size) {
+    switch (m_interface) {
+
+        case INTERFACE_I2C_BUFFERED:
+        case INTERFACE_SPI_3WIRES:
+        case INTERFACE_SPI_4WIRES:
+        case INTERFACE_TRANSPORT: {
+            if (cache == NULL) {
+                m_glyph_entries = NULL;
+                return 0;
+            }
+
+            /* Place the index at the start of the buffer, suitably aligned, and the glyph bitmaps after it */
+            const size_t padding = (alignof(struct glyph_entry) - ((uintptr_t)cache % alignof(struct glyph_entry))) % alignof(struct glyph_entry);
+            const size_t index_size = SH1106_GLYPH_CACHE_ENTRIES * sizeof(struct glyph_entry);
+            if (size <= padding + index_size) {
+                return -EINVAL;
+            }
+            m_glyph_entries = (struct glyph_entry*)(cache + padding);
+            m_glyph_data = cache + padding + index_size;
+            m_glyph_data_size = size - padding - index_size;
+            if (m_glyph_data_size > 0xFFFF) m_glyph_data_size = 0xFFFF;
+            m_glyph_data_used = 0;
+            memset(m_glyph_entries, 0, index_size);
+            return 0;
+        }
+
+        case INTERFACE_I2C_LIGHT: {  // Without a local buffer, glyphs can not be copied
+            return -EINVAL;
+        }
+
+        default: {
+            return -EINVAL;
+        }
+    }
+}
+
+/**
+ * Draws a character at the cursor using the glyph cache, mirroring what Adafruit_GFX::write() does.
+ * @param[in] c The character.
+ * @return 0 if the character was handled, or a negative error code if it has to go through Adafruit_GFX.
+ */
+int sh1106::m_glyph_write(const uint8_t c) {
+
+    /* Only handle what the cache can reproduce exactly, glyphs being monochrome */
+    if (m_glyph_entries == NULL || m_grayscale != NULL || c == '\n' || c == '\r') {
+        return -EINVAL;
+    }
+    const bool opaque = (gfxFont == NULL) && (textbgcolor != textcolor);
+    if (opaque && ((textcolor != 0) == (textbgcolor != 0))) {
+        return -EINVAL;
+    }
+
+    /* Retrieve glyph box, relative to the cursor */
+    int16_t x_box, y_box, w_box, h_box, wrap_right, advance, line;
+    if (gfxFont == NULL) {
+        x_box = 0;
+        y_box = 0;
+        w_box = textsize_x * 6;
+        h_box = textsize_y * 8;
+        wrap_right = textsize_x * 6;
+        advance = textsize_x * 6;
+        line = textsize_y * 8;
+    } else {
+        const uint8_t first = pgm_read_byte(&gfxFont->first);
+        if (c < first || c > (uint8_t)pgm_read_byte(&gfxFont->last)) {
+            return 0;
+        }
+        const GFXglyph* glyph = sh1106_font_glyph_get(gfxFont, c - first);
+        const uint8_t w = pgm_read_byte(&glyph->width), h = pgm_read_byte(&glyph->height);
+        const int8_t xo = (int8_t)pgm_read_byte(&glyph->xOffset), yo = (int8_t)pgm_read_byte(&glyph->yOffset);
+        advance = (int16_t)pgm_read_byte(&glyph->xAdvance) * textsize_x;
+        if (w == 0 || h == 0) {
+            cursor_x += advance;
+            return 0;
+        }
+        x_box = xo * textsize_x;
+        y_box = yo * textsize_y;
+        w_box = w * textsize_x;
+        h_box = h * textsize_y;
+        wrap_right = textsize_x * (xo + w);
+        line = textsize_y * (uint8_t)pgm_read_byte(&gfxFont->yAdvance);
+    }
+    if (w_box > 255 || h_box > 255) {
+        return -EINVAL;
+    }
+    const int16_t w_panel = (rotation & 1) ? h_box : w_box;
+    const int16_t h_panel = (rotation & 1) ? w_box : h_box;
+
+    /* Look the glyph up, converting it if it is not cached yet */
+    const uint8_t key_rotation = rotation | (_cp437 ? 4 : 0);
+    struct glyph_entry& entry = m_glyph_entries[(c + textsize_x * 3 + textsize_y * 5 + key_rotation * 11 + (((uintptr_t)gfxFont) >> 2)) % SH1106_GLYPH_CACHE_ENTRIES];
+    if (entry.size_x == 0 || entry.character != c || entry.font != gfxFont || entry.size_x != textsize_x || entry.size_y != textsize_y || entry.rotation != key_rotation) {
+        const size_t length = w_panel * ((h_panel + 7) / 8);
+        if (length > m_glyph_data_size) {
+            return -EINVAL;
+        }
+        if (m_glyph_data_used + length > m_glyph_data_size) {
+            memset(m_glyph_entries, 0, SH1106_GLYPH_CACHE_ENTRIES * sizeof(struct glyph_entry));
+            m_glyph_data_used = 0;
+        }
+        uint8_t* bitmap = &m_glyph_data[m_glyph_data_used];
+        memset(bitmap, 0, length);
+        sh1106_glyph_canvas canvas(w_box, h_box, rotation, bitmap);
+        canvas.setFont(gfxFont);
+        canvas.cp437(_cp437);
+        canvas.drawChar(-x_box, -y_box, c, 1, 1, textsize_x, textsize_y);
+        entry.font = gfxFont;
+        entry.offset = m_glyph_data_used;
+        entry.character = c;
+        entry.size_x = textsize_x;
+        entry.size_y = textsize_y;
+        entry.rotation = key_rotation;
+        m_glyph_data_used += length;
+    }
+
+    /* Wrap, like Adafruit_GFX::write() does */
+    if (wrap && cursor_x + wrap_right > _width) {
+        cursor_x = 0;
+        cursor_y += line;
+    }
+
+    /* Copy the glyph in panel coordinates */
+    const int16_t x = cursor_x + x_box, y = cursor_y + y_box;
+    int16_t x_panel, y_panel;
+    switch (rotation) {
+        case 1: x_panel = (int16_t)m_active_width - y - h_box, y_panel = x; break;
+        case 2: x_panel = (int16_t)m_active_width - x - w_box, y_panel = (int16_t)m_active_height - y - h_box; break;
+        case 3: x_panel = y, y_panel = (int16_t)m_active_height - x - w_box; break;
+        default: x_panel = x, y_panel = y; break;
+    }
+    const uint8_t invert = (textcolor != 0) ? 0x00 : 0xFF;
+    const enum operation operation = opaque ? OPERATION_COPY : ((textcolor != 0) ? OPERATION_OR : OPERATION_AND);
+    m_buffer_bitmap_draw(x_panel, y_panel, &m_glyph_data[entry.offset], w_panel, h_panel, BITMAP_FORMAT_PAGES, operation, invert);
+    cursor_x += advance;
+    return 0;
+}
+
+/**
+ * Prints a character, scrolling the screen when in console mode, and using the glyph cache when there is one.
+ */
+size_t sh1106::write(uint8_t c) {
+    if (m_console && gfxFont == NULL && rotation == 0 && textsize_y == 1 && c != '\r') {
+        const bool line_new = (c == '\n') || (wrap && (cursor_x + textsize_x * 6) > _width);
+        if (line_new) {
+            cursor_x = 0;
+            if (cursor_y + 16 > _height && scroll_up() == 0) {
+                /* Keep the cursor on the bottom line */
+            } else {
+                cursor_y += 8;
+            }
+            if (c == '\n') {
+                return 1;
+            }
+        }
+    }
+    if (m_glyph_write(c) == 0) {
+        return 1;
+    }
+    return Adafruit_GFX::write(c);
+}
+
+/**
+ * Marks the whole local buffer as needing to be sent on the next call to display().
+ * This should be called after modifying the buffer without going through this class.
+ * @return 0 in case of success, or a negative error code otherwise.
+ */
+int sh1106::invalidate(void) {
+    switch (m_interface) {
+
+        case INTERFACE_I2C_BUFFERED:
+        case INTERFACE_SPI_3WIRES:
+        case INTERFACE_SPI_4WIRES:
+        case INTERFACE_TRANSPORT: {
+            m_dirty_mark_all();
+            m_shadow_valid = false;
+            m_flush_shadow_validates = false;
+            return 0;
+        }
+
+        case INTERFACE_I2C_LIGHT: {  // For unbuffered interface, gdram is always up to date
+            return 0;
+        }
+
+        default: {
+            return -EINVAL;
+        }
+    }
+}
+
+/**
+ * Provides a second buffer that will hold a copy of the last frame sent to the gdram.
+ * When set, display() compares the local buffer against it and only sends the bytes that actually changed, which helps when the application redraws the whole screen every frame.
+ * @param[in] shadow A pointer to a buffer of the same size as the local buffer, or NULL to stop using one.
+ * @return 0 in case of success, or a negative error code otherwise.
+ */
+int sh1106::shadow_set(uint8_t* const shadow) {
+    switch (m_interface) {
+
+        case INTERFACE_I2C_BUFFERED:
+        case INTERFACE_SPI_3WIRES:
+        case INTERFACE_SPI_4WIRES:
+        case INTERFACE_TRANSPORT: {
+            if (m_buffer_pages < (m_active_height + 7) / 8) {  // Not possible while rendering strips
+                return -EINVAL;
+            }
+            m_shadow = shadow;
+            m_shadow_valid = false;
+            m_flush_shadow_validates = false;
+            m_dirty_mark_all();
+            return 0;
+        }
+
+        default: {
+            return -EINVAL;
+        }
+    }
+}
+
+#if SH1106_STATS
+/**
+ * Gives access to counters of what was sent to the panel, which are only available when SH1106_STATS is set to 1.
+ * @return The counters, which keep being updated.
+ */
+const struct sh1106::stats& sh1106::stats_get(void) const {
+    return m_stats;
+}
+
+/**
+ * Resets the counters returned by stats_get().
+ */
+void sh1106::stats_reset(void) {
+    m_stats = {};
+    m_stats_frame_bytes = 0;
+    m_stats_frame_transactions = 0;
+}
+
+/**
+ * Takes the snapshot the per-frame counters are computed from, when a transfer of the local buffer starts.
+ */
+void sh1106::m_stats_frame_begin(void) {
+    m_stats_frame_start = micros();
+    m_stats_frame_bytes = m_stats.bytes_command + m_stats.bytes_data;
+    m_stats_frame_transactions = m_stats.transactions;
+    memset(m_stats.page_us, 0, sizeof(m_stats.page_us));
+}
+#endif
+
+/**
+ *
+ * @param[in] command
+ */
+int sh1106::command_send(const uint8_t command) {
+    int res;
+    switch (m_interface) {
+
+        case INTERFACE_I2C_BUFFERED:
+        case INTERFACE_I2C_LIGHT: {
+            m_i2c_library->beginTransmission(m_i2c_address);
+            m_i2c_library->write(0x00);  // CO = 0, DC = 0
+            m_i2c_library->write(command);
+            res = m_i2c_library->endTransmission(true);
+            SH1106_STATS_ADD(transactions, 1);
+            if (res != 0) {
+                SH1106_STATS_ADD(errors, 1);
+                return -EIO;
+            }
+            SH1106_STATS_ADD(bytes_command, 1);
+            return 0;
+        }
+
+        case INTERFACE_SPI_3WIRES:
+        case INTERFACE_SPI_4WIRES:
+        case INTERFACE_TRANSPORT: {
+            SH1106_STATS_ADD(bytes_command, 1);
+            m_window_open();
+            res = m_spi_write(false, &command, 1);
+            m_window_close();
+            return res;
+        }
+
+        default: {
+            return -EINVAL;
+        }
+    }
+}
+
+/**
+ *
+ * @param[in] command
+ * @param[in] parameter
+ */
+int sh1106::command_send(const uint8_t command, const uint8_t parameter) {
+    int res;
+    switch (m_interface) {
+
+        case INTERFACE_I2C_BUFFERED:
+        case INTERFACE_I2C_LIGHT: {
+            m_i2c_library->beginTransmission(m_i2c_address);
+            m_i2c_library->write(0x00);  // CO = 0, DC = 0
+            m_i2c_library->write(command);
+            m_i2c_library->write(parameter);
+            res = m_i2c_library->endTransmission(true);
+            SH1106_STATS_ADD(transactions, 1);
+            if (res != 0) {
+                SH1106_STATS_ADD(errors, 1);
+                return -EIO;
+            }
+            SH1106_STATS_ADD(bytes_command, 2);
+            return 0;
+        }
+
+        case INTERFACE_SPI_3WIRES:
+        case INTERFACE_SPI_4WIRES:
+        case INTERFACE_TRANSPORT: {
+            const uint8_t bytes[2] = {command, parameter};
+            SH1106_STATS_ADD(bytes_command, 2);
+            m_window_open();
+            res = m_spi_write(false, bytes, 2);
+            m_window_close();
+            return res;
+        }
+
+        default: {
+            return -EINVAL;
+        }
+    }
+}
+
+/**
+ * Sends a sequence of commands and parameters in a single bus transaction.
+ * In i2c, sequences longer than what the wire library can buffer are split over several transactions, between commands so that no parameter is read as a command.
+ * @param[in] commands The commands and their parameters, in order.
+ * @param[in] length The number of bytes in the sequence.
+ * @return 0 in case of success, or a negative error code otherwise.
+ */
+int sh1106::commands_send(const uint8_t* const commands, const size_t length) {
+    int res;
+    switch (m_interface) {
+
+        case INTERFACE_I2C_BUFFERED:
+        case INTERFACE_I2C_LIGHT: {
+            for (size_t i = 0; i < length;) {
+                size_t chunk = 0;
+                while (i + chunk < length) {
+                    size_t size = m_command_length(commands[i + chunk]);
+                    if (size > length - i - chunk) size = length - i - chunk;
+                    if (chunk + size > SH1106_I2C_BUFFER_LENGTH - 1) break;
+                    chunk += size;
+                }
+                if (chunk == 0) {  // The wire library can not even hold a command with its parameter
+                    return -EINVAL;
+                }
+                m_i2c_library->beginTransmission(m_i2c_address);
+                m_i2c_library->write(0x00);  // CO = 0, DC = 0
+                m_i2c_library->write(&commands[i], chunk);
+                res = m_i2c_library->endTransmission(true);
+                SH1106_STATS_ADD(transactions, 1);
+                if (res != 0) {
+                    SH1106_STATS_ADD(errors, 1);
+                    return -EIO;
+                }
+                SH1106_STATS_ADD(bytes_command, chunk);
+                i += chunk;
+            }
+            return 0;
+        }
+
+        case INTERFACE_SPI_3WIRES:
+        case INTERFACE_SPI_4WIRES:
+        case INTERFACE_TRANSPORT: {
+            SH1106_STATS_ADD(bytes_command, length);
+            m_window_open();
+            res = m_spi_write(false, commands, length);
+            m_window_close();
+            return res;
+        }
+
+        default: {
+            return -EINVAL;
+        }
+    }
+}
+
+/**
+ *
+ */
+int sh1106::data_send(const uint8_t data) {
+    int res;
+    switch (m_interface) {
+
+        case INTERFACE_I2C_BUFFERED:
+        case INTERFACE_I2C_LIGHT: {
+            m_i2c_library->beginTransmission(m_i2c_address);
+            m_i2c_library->write(0x40);  // CO = 0, DC = 1
+            m_i2c_library->write(data);
+            res = m_i2c_library->endTransmission(true);
+            SH1106_STATS_ADD(transactions, 1);
+            if (res != 0) {
+                SH1106_STATS_ADD(errors, 1);
+                return -EIO;
+            }
+            SH1106_STATS_ADD(bytes_data, 1);
+            return 0;
+        }
+
+        case INTERFACE_SPI_3WIRES:
+        case INTERFACE_SPI_4WIRES:
+        case INTERFACE_TRANSPORT: {
+            SH1106_STATS_ADD(bytes_data, 1);
+            m_window_open();
+            res = m_spi_write(true, &data, 1);
+            m_window_close();
+            return res;
+        }
+
+        default: {
+            return -EINVAL;
+        }
+    }
+}
+
+/**
+ *
+ */
+int sh1106::data_send(uint8_t* const data, const size_t length) {
+    int res;
+    switch (m_interface) {
+
+        case INTERFACE_I2C_BUFFERED:
+        case INTERFACE_I2C_LIGHT: {
+            for (size_t i = 0; i < length;) {
+                m_i2c_library->beginTransmission(m_i2c_address);
+                m_i2c_library->write(0x40);  // CO = 0, DC = 1
+                const size_t chunk = m_i2c_library->write(&data[i], length - i);
+                res = m_i2c_library->endTransmission(true);
+                SH1106_STATS_ADD(transactions, 1);
+                if (res != 0) {
+                    SH1106_STATS_ADD(errors, 1);
+                    return -EIO;
+                }
+                SH1106_STATS_ADD(bytes_data, chunk);
+                i += chunk;
+            }
+            return 0;
+        }
+
+        case INTERFACE_SPI_3WIRES:
+        case INTERFACE_SPI_4WIRES:
+        case INTERFACE_TRANSPORT: {
+            SH1106_STATS_ADD(bytes_data, length);
+            m_window_open();
+            res = m_spi_write(true, data, length);
+            m_window_close();
+            return res;
+        }
+
+        default: {
+            return -EINVAL;
+        }
+    }
+}
+
+/**
+ * Resets the panel, configures it, clears its gdram and turns it on.
+ * @param[in] pin_res The gpio connected to the reset pin of the panel.
+ * @return 0 in case of success, or a negative error code otherwise.
+ */
+int sh1106::m_panel_init(const int pin_res) {
+    int res;
+
+    /* Perform reset, if the reset pin is wired */
+    if (pin_res >= 0) {
+        pinMode(pin_res, OUTPUT);
+        digitalWrite(pin_res, LOW);
+        delay(1);
+        digitalWrite(pin_res, HIGH);
+        delay(1);
+    }
+
+    /* Configure panel */
+    m_scroll_pages = 0;
+    res = commands_send(sh1106_init_sequence, sizeof(sh1106_init_sequence));
+    if (res < 0) {
+        return res;
+    }
+    res = command_send(COMMAND_MULTIPLEX_SET, m_active_height - 1);
+    if (res < 0) {
+        return res;
+    }
+
+    /* Clear gdram */
+    for (size_t i = 0; i < (m_gdram_height + 7) / 8; i++) {
+        res = m_gdram_write(i, 0, NULL, m_gdram_width);
+        if (res < 0) {
+            return res;
+        }
+    }
+
+    /* Turn panel on */
+    return command_send(COMMAND_DISPLAY_ON);
+}
+
+/**
+ * Gives access to a page of the local buffer.
+ * @param[in] page The page of the panel.
+ * @return A pointer to the first column of the page in the local buffer, or NULL if the page is not in the strip currently held by the buffer.
+ */
+uint8_t* sh1106::m_buffer_page(const size_t page) const {
+    if (page < m_buffer_page_first || page >= m_buffer_page_first + m_buffer_pages || page >= (m_active_height + 7) / 8) {
+        return NULL;
+    }
+    return &m_buffer[(page - m_buffer_page_first) * m_active_width];
+}
+
+/**
+ * Extends the range of columns of a page that will be sent on the next call to display().
+ * @param[in] page The page that was modified.
+ * @param[in] column_min The first column that was modified.
+ * @param[in] column_max The last column that was modified.
+ */
+void sh1106::m_dirty_mark(const size_t page, const size_t column_min, const size_t column_max) {
+    if (column_min < m_dirty_min[page]) m_dirty_min[page] = column_min;
+    if (column_max > m_dirty_max[page]) m_dirty_max[page] = column_max;
+}
+
+/**
+ * Marks every column of every page as needing to be sent on the next call to display().
+ */
+void sh1106::m_dirty_mark_all(void) {
+    for (size_t i = 0; i < (m_gdram_height + 7) / 8; i++) {
+        m_dirty_min[i] = 0;
+        m_dirty_max[i] = m_active_width - 1;
+    }
+}
+
+/**
+ * Starts sending a whole buffer, or only the bytes that differ from the gdram if there is a valid shadow buffer.
+ * The transfer is then carried out by m_flush_step().
+ * @param[in] buffer The buffer, laid out as the local buffer.
+ */
+void sh1106::m_flush_start(const uint8_t* const buffer) {
+    m_flush_active = true;
+    m_flush_full = true;
+    m_flush_buffer = buffer;
+    m_flush_page_next = 0;
+    m_flush_column = 0;
+    m_flush_column_end = 0;
+    m_flush_shadow_validates = true;
+#if SH1106_STATS
+    m_stats_frame_begin();
+#endif
+}
+
+/**
+ * Finds the next run of bytes of a page of the local buffer that needs to be sent to the gdram.
+ * When a valid shadow buffer is available, only bytes that differ from it are considered, and runs separated by fewer equal bytes than it costs to seek are merged. Otherwise the whole range is one run.
+ * @param[in] page The page to look into.
+ * @param[in] column_start The first column to consider.
+ * @param[in] column_end The column after the last one to consider.
+ * @param[out] run_start The first column of the run.
+ * @param[out] run_stop The column after the last one of the run.
+ * @return true if a run was found, false if the range does not need to be sent.
+ */
+bool sh1106::m_run_find(const size_t page, const size_t column_start, const size_t column_end, size_t& run_start, size_t& run_stop) const {
+
+    /* Without a valid shadow, send everything */
+    if (m_shadow == NULL || !m_shadow_valid) {
+        run_start = column_start;
+        run_stop = column_end;
+        return column_start < column_end;
+    }
+    const uint8_t* buffer = &m_flush_buffer[page * m_active_width];
+    const uint8_t* shadow = &m_shadow[page * m_active_width];
+
+    /* Number of bytes it costs to start a new run: in i2c a new transaction with the page and column addresses, in spi the three address commands */
+    const size_t seek_cost = (m_interface == INTERFACE_I2C_BUFFERED) ? 9 : 3;
+
+    /* Skip bytes that are identical, a word at a time */
+    size_t start = column_start;
+    while (start + 4 <= column_end) {
+        uint32_t a, b;
+        memcpy(&a, &buffer[start], 4);
+        memcpy(&b, &shadow[start], 4);
+        if (a != b) break;
+        start += 4;
+    }
+    while (start < column_end && buffer[start] == shadow[start]) {
+        start++;
+    }
+    if (start >= column_end) {
+        return false;
+    }
+
+    /* Extend the run over differing bytes, and over gaps of identical bytes that are cheaper to resend than to seek over */
+    size_t stop = start + 1;
+    while (stop < column_end) {
+        size_t gap = 0;
+        while (stop + gap < column_end && buffer[stop + gap] == shadow[stop + gap] && gap <= seek_cost) {
+            gap++;
+        }
+        if (stop + gap >= column_end || gap > seek_cost) {
+            break;
+        }
+        stop += gap + 1;
+    }
+    run_start = start;
+    run_stop = stop;
+    return true;
+}
+
+/**
+ * Writes a run of bytes into a page of the gdram, starting at the given gdram column.
+ * In i2c, the page and column address commands are packed in the same transaction as the data, and the data is split into transactions as large as the wire library allows.
+ * @param[in] page The page to write to, relative to the top of the screen.
+ * @param[in] column The first gdram column to write to, the active area starting at m_blanking_h.
+ * @param[in] data The bytes to write, or NULL to write zeros.
+ * @param[in] length The number of bytes to write.
+ * @return 0 in case of success, or a negative error code otherwise.
+ */
+int sh1106::m_gdram_write(const size_t page, const size_t column, const uint8_t* const data, const size_t length) {
+    int res;
+    const size_t page_gdram = (page + m_scroll_pages) % (m_gdram_height / 8);
+    switch (m_interface) {
+
+        case INTERFACE_I2C_BUFFERED:
+        case INTERFACE_I2C_LIGHT: {
+            m_i2c_library->beginTransmission(m_i2c_address);
+            m_i2c_library->write(0x80);  // CO = 1, DC = 0
+            m_i2c_library->write(COMMAND_PAGE_ADDRESS + page_gdram);
+            m_i2c_library->write(0x80);  // CO = 1, DC = 0
+            m_i2c_library->write(COMMAND_COLUMN_ADDRESS_L | (column & 0x0F));
+            m_i2c_library->write(0x80);  // CO = 1, DC = 0
+            m_i2c_library->write(COMMAND_COLUMN_ADDRESS_H | (column >> 4));
+            m_i2c_library->write(0x40);  // CO = 0, DC = 1
+            SH1106_STATS_ADD(bytes_command, 3);
+            size_t room = SH1106_I2C_BUFFER_LENGTH - 7;
+            for (size_t i = 0;;) {
+                size_t chunk = length - i;
+                if (chunk > room) chunk = room;
+                if (data != NULL) {
+                    m_i2c_library->write(&data[i], chunk);
+                } else {
+                    for (size_t j = 0; j < chunk; j++) {
+                        m_i2c_library->write(0x00);
+                    }
+                }
+                i += chunk;
+                res = m_i2c_library->endTransmission(true);
+                SH1106_STATS_ADD(transactions, 1);
+                if (res != 0) {
+                    SH1106_STATS_ADD(errors, 1);
+                    return -EIO;
+                }
+                SH1106_STATS_ADD(bytes_data, chunk);
+                if (i >= length) {
+                    return 0;
+                }
+                m_i2c_library->beginTransmission(m_i2c_address);
+                m_i2c_library->write(0x40);  // CO = 0, DC = 1
+                room = SH1106_I2C_BUFFER_LENGTH - 1;
+            }
+        }
+
+        case INTERFACE_SPI_3WIRES:
+        case INTERFACE_SPI_4WIRES:
+        case INTERFACE_TRANSPORT: {
+            const uint8_t commands[3] = {
+                (uint8_t)(COMMAND_PAGE_ADDRESS + page_gdram),
+                (uint8_t)(COMMAND_COLUMN_ADDRESS_L | (column & 0x0F)),
+                (uint8_t)(COMMAND_COLUMN_ADDRESS_H | (column >> 4)),
+            };
+            SH1106_STATS_ADD(bytes_command, 3);
+            SH1106_STATS_ADD(bytes_data, length);
+            m_window_open();
+            res = m_spi_write(false, commands, 3);
+            if (res == 0) {
+                res = m_spi_write(true, data, length);
+            }
+            m_window_close();
+            return res;
+        }
+
+        default: {
+            return -EINVAL;
+        }
+    }
+}
+
+/**
+ * Reads a run of bytes from a page of the gdram, starting at the given gdram column.
+ * The gdram column address is incremented after each read, so the whole run comes back in a single request, after the dummy read required by the controller.
+ * @param[in] page The page to read from, relative to the top of the screen.
+ * @param[in] column The first gdram column to read, the active area starting at m_blanking_h.
+ * @param[out] data The bytes read.
+ * @param[in] length The number of bytes to read, at most SH1106_I2C_BUFFER_LENGTH - 1 and 254.
+ * @return 0 in case of success, or a negative error code otherwise.
+ */
+int sh1106::m_gdram_read(const size_t page, const size_t column, uint8_t* const data, const size_t length) {
+    const size_t page_gdram = (page + m_scroll_pages) % (m_gdram_height / 8);
+    switch (m_interface) {
+
+        case INTERFACE_I2C_BUFFERED:
+        case INTERFACE_I2C_LIGHT: {
+            m_i2c_library->beginTransmission(m_i2c_address);
+            m_i2c_library->write(0x80);  // CO = 1, DC = 0
+            m_i2c_library->write(COMMAND_PAGE_ADDRESS + page_gdram);
+            m_i2c_library->write(0x80);  // CO = 1, DC = 0
+            m_i2c_library->write(COMMAND_COLUMN_ADDRESS_L | (column & 0x0F));
+            m_i2c_library->write(0x80);  // CO = 1, DC = 0
+            m_i2c_library->write(COMMAND_COLUMN_ADDRESS_H | (column >> 4));
+            m_i2c_library->write(0x40);  // CO = 0, DC = 1
+            SH1106_STATS_ADD(round_trips, 1);
+            SH1106_STATS_ADD(transactions, 2);
+            if (m_i2c_library->endTransmission(false) != 0) {
+                SH1106_STATS_ADD(errors, 1);
+                return -EIO;
+            }
+            SH1106_STATS_ADD(bytes_command, 3);
+            if (m_i2c_library->requestFrom(m_i2c_address, (uint8_t)(length + 1), (uint8_t) true) != length + 1) {
+                SH1106_STATS_ADD(errors, 1);
+                return -EIO;
+            }
+            SH1106_STATS_ADD(bytes_read, length);
+            m_i2c_library->read();  // Dummy read
+            for (size_t i = 0; i < length; i++) {
+                data[i] = m_i2c_library->read();
+            }
+            return 0;
+        }
+
+        default: {  // Reading is not possible in spi
+            return -EINVAL;
+        }
+    }
+}
+
+/**
+ * Forgets the gdram bytes cached by the unbuffered mode, when the gdram they mirror may have changed.
+ */
+void sh1106::m_gdram_cache_clear(void) {
+#if SH1106_GDRAM_CACHE_SIZE > 0
+    memset(m_gdram_cache, 0, sizeof(m_gdram_cache));
+#endif
+}
+
+/**
+ * Sets or clears bits over a run of columns of a page of the gdram.
+ * The run is read in as few requests as possible, modified and written back in as few transactions as possible. Recently accessed gdram bytes are kept in a small cache, so repeated modifications of the same bytes do not need to read them again.
+ * @param[in] page The gdram page to modify.
+ * @param[in] column_first The first column to modify, relative to the active area.
+ * @param[in] column_last The last column to modify, relative to the active area.
+ * @param[in] mask The bits to modify in each byte.
+ * @param[in] color
+ * @param[in] masks Optionally, the bits to modify in each byte of the run, used instead of mask.
+ * @return 0 in case of success, or a negative error code otherwise.
+ */
+int sh1106::m_gdram_span_modify(const size_t page, const size_t column_first, const size_t column_last, const uint8_t mask, const uint16_t color, const uint8_t* const masks) {
+    int res;
+    uint8_t bytes[(SH1106_I2C_BUFFER_LENGTH > 255) ? 254 : (SH1106_I2C_BUFFER_LENGTH - 1)];  // Bounded by the wire receive buffer and the 8-bit request length
+    for (size_t start = column_first; start <= column_last;) {
+        size_t length = column_last - start + 1;
+        if (length > sizeof(bytes)) length = sizeof(bytes);
+
+        /* Retrieve current bytes, unless they are all overwritten or all cached */
+        if (masks != NULL || mask != 0xFF) {
+#if SH1106_GDRAM_CACHE_SIZE > 0
+            bool cached = true;
+            for (size_t i = 0; i < length; i++) {
+                const struct gdram_cache_entry& entry = m_gdram_cache[(start + i + page * 7) % SH1106_GDRAM_CACHE_SIZE];
+                if (entry.tag != m_gdram_cache_tag(page, start + i)) {
+                    cached = false;
+                    break;
+                }
+                bytes[i] = entry.value;
+            }
+#else
+            const bool cached = false;
+#endif
+            if (!cached) {
+                res = m_gdram_read(page, m_blanking_h + start, bytes, length);
+                if (res < 0) {
+                    return res;
+                }
+            }
+        }
+
+        /* Modify them */
+        for (size_t i = 0; i < length; i++) {
+            const uint8_t bits = (masks != NULL) ? masks[start - column_first + i] : mask;
+            if (bits == 0xFF) {
+                bytes[i] = color ? 0xFF : 0x00;
+            } else if (color) {
+                bytes[i] |= bits;
+            } else {
+                bytes[i] &= ~bits;
+            }
+        }
+
+        /* Write them back */
+        res = m_gdram_write(page, m_blanking_h + start, bytes, length);
+        if (res < 0) {
+            m_gdram_cache_clear();
+            return res;
+        }
+#if SH1106_GDRAM_CACHE_SIZE > 0
+        for (size_t i = 0; i < length; i++) {
+            struct gdram_cache_entry& entry = m_gdram_cache[(start + i + page * 7) % SH1106_GDRAM_CACHE_SIZE];
+            entry.tag = m_gdram_cache_tag(page, start + i);
+            entry.value = bytes[i];
+        }
+#endif
+        start += length;
+    }
+    return 0;
+}
+
+/**
+ * Sets or clears bits of a page of the gdram, column by column.
+ * Columns to modify are grouped into runs, each read and written back at once, a short gap of untouched columns being cheaper to carry along than a new run.
+ * @param[in] page The gdram page to modify.
+ * @param[in] masks For each column of the active area, the bits to modify.
+ * @param[in] color
+ * @return 0 in case of success, or a negative error code otherwise.
+ */
+int sh1106::m_gdram_masks_apply(const size_t page, const uint8_t* const masks, const uint16_t color) {
+    const size_t gap_max = 8;  // Two bytes on the bus per column carried along, against about sixteen to address a new run
+    for (size_t column = 0; column < m_active_width;) {
+        if (masks[column] == 0) {
+            column++;
+            continue;
+        }
+        size_t last = column;
+        for (size_t next = column + 1; next < m_active_width && next <= last + gap_max; next++) {
+            if (masks[next] != 0) {
+                last = next;
+            }
+        }
+        int res = m_gdram_span_modify(page, column, last, 0x00, color, &masks[column]);
+        if (res < 0) {
+            return res;
+        }
+        column = last + 1;
+    }
+    return 0;
+}
+
+/**
+ * Tells how many bytes a command takes with its parameter, for the commands of the sh1106 that have one.
+ * @param[in] command The first byte of the command.
+ * @return 2 for a double byte command, 1 otherwise.
+ */
+size_t sh1106::m_command_length(const uint8_t command) {
+    switch (command) {
+        case COMMAND_CONTRAST_SET:
+        case COMMAND_MULTIPLEX_SET:
+        case 0xAD:  // Dc-dc control mode
+        case COMMAND_DISPLAY_OFFSET_SET:
+        case COMMAND_FREQUENCY_SET:
+        case COMMAND_PRECHARGE_PERIOD_SET:
+        case COMMAND_PADS_CONFIGURATION:
+        case COMMAND_VCOMH_DESELECT_LEVEL_SET:
+            return 2;
+        default:
+            return 1;
+    }
+}
+
+/**
+ * Starts a window during which consecutive transfers share the same bus transaction.
+ * In spi, the chip select is held low until the matching call to m_window_close(), so a whole frame can be sent with a single transaction. Windows can be nested.
+ */
+void sh1106::m_window_open(void) {
+    switch (m_interface) {
+        case INTERFACE_SPI_3WIRES:
+        case INTERFACE_SPI_4WIRES: {
+            if (m_window_depth++ == 0) {
+                SH1106_STATS_ADD(transactions, 1);
+                m_spi_library->beginTransaction(m_spi_settings);
+                digitalWrite(m_pin_cs, LOW);
+            }
+            break;
+        }
+        case INTERFACE_TRANSPORT: {
+            if (m_window_depth++ == 0) {
+                SH1106_STATS_ADD(transactions, 1);
+                m_transport->window_open();
+            }
+            break;
+        }
+        default: {
+            break;
+        }
+    }
+}
+
+/**
+ * Ends a window started with m_window_open().
+ */
+void sh1106::m_window_close(void) {
+    switch (m_interface) {
+        case INTERFACE_SPI_3WIRES:
+        case INTERFACE_SPI_4WIRES: {
+            if (m_window_depth > 0 && --m_window_depth == 0) {
+#if SH1106_SPI_3WIRES_GROUPS > 0
+                if (m_interface == INTERFACE_SPI_3WIRES && m_spi_words_count > 0) {
+                    while (m_spi_words_count % 8 != 0) {  // Pad the last group of 8 words with nops, so no partial word is clocked in
+                        m_spi_word_push(false, COMMAND_NOP);
+                    }
+                    m_spi_words_flush();
+                }
+#endif
+                digitalWrite(m_pin_cs, HIGH);
+                m_spi_library->endTransaction();
+            }
+            break;
+        }
+        case INTERFACE_TRANSPORT: {
+            if (m_window_depth > 0 && --m_window_depth == 0) {
+                m_transport->window_close();
+            }
+            break;
+        }
+        default: {
+            break;
+        }
+    }
+}
+
+/**
+ * Sends bytes over spi, or through the custom transport, within a window opened with m_window_open().
+ * The data/command pin is only toggled when switching between commands and data, and the bytes are sent with the buffer form of the spi library so the core can use its fifo or dma.
+ * @param[in] dc false to send commands, true to send data.
+ * @param[in] bytes The bytes to send, or NULL to send zeros. They are not modified.
+ * @param[in] length The number of bytes to send.
+ * @return 0 in case of success, or a negative error code reported by the custom transport.
+ */
+int sh1106::m_spi_write(const bool dc, const uint8_t* const bytes, const size_t length) {
+
+    /* With a custom transport, hand the bytes over */
+    if (m_interface == INTERFACE_TRANSPORT) {
+        int res = m_transport->write(dc, bytes, length);
+        if (res < 0) {
+            SH1106_STATS_ADD(errors, 1);
+            return res;
+        }
+        return 0;
+    }
+
+#if SH1106_SPI_3WIRES_GROUPS > 0
+    /* In 3-wires, the data/command bit goes with each byte */
+    if (m_interface == INTERFACE_SPI_3WIRES) {
+        for (size_t i = 0; i < length; i++) {
+            m_spi_word_push(dc, (bytes != NULL) ? bytes[i] : 0x00);
+        }
+        return 0;
+    }
+#endif
+
+    /* Toggle data/command pin if needed */
+    if (dc != m_spi_dc) {
+        digitalWrite(m_pin_dc, dc ? HIGH : LOW);
+        m_spi_dc = dc;
+    }
+
+    /* Send bytes */
+    m_spi_transfer(bytes, length);
+    return 0;
+}
+
+/**
+ * Sends raw bytes over spi without touching the data/command pin.
+ * @param[in] bytes The bytes to send, or NULL to send zeros. They are not modified.
+ * @param[in] length The number of bytes to send.
+ */
+void sh1106::m_spi_transfer(const uint8_t* const bytes, const size_t length) {
+#if defined(ARDUINO_ARCH_ESP32) || defined(ARDUINO_ARCH_ESP8266)
+    if (bytes != NULL) {
+        m_spi_library->writeBytes(bytes, length);
+        return;
+    }
+#endif
+    uint8_t chunk[32];  // The buffer form of transfer() overwrites the buffer with received bytes, so go through a copy
+    for (size_t i = 0; i < length;) {
+        size_t count = length - i;
+        if (count > sizeof(chunk)) count = sizeof(chunk);
+        if (bytes != NULL) {
+            memcpy(chunk, &bytes[i], count);
+        } else {
+            memset(chunk, 0x00, count);
+        }
+        m_spi_library->transfer(chunk, count);
+        i += count;
+    }
+}
+
+#if SH1106_SPI_3WIRES_GROUPS > 0
+/**
+ * Queues a 9-bit word for a 3-wires spi transfer.
+ * Words are packed msb first, eight words in nine bytes, so they can be sent in bulk by the spi peripheral.
+ * @param[in] dc false for a command, true for data.
+ * @param[in] byte The command or data byte.
+ */
+void sh1106::m_spi_word_push(const bool dc, const uint8_t byte) {
+    const uint16_t word = (dc ? 0x100 : 0x000) | byte;
+    const size_t base = (m_spi_words_count / 8) * 9;
+    const size_t shift = m_spi_words_count % 8;
+    m_spi_words[base + shift] |= word >> (1 + shift);
+    m_spi_words[base + shift + 1] |= (uint8_t)(word << (7 - shift));
+    m_spi_words_count++;
+    if (m_spi_words_count == (sizeof(m_spi_words) / 9) * 8) {
+        m_spi_words_flush();
+    }
+}
+
+/**
+ * Sends the complete groups of 8 words queued by m_spi_word_push().
+ */
+void sh1106::m_spi_words_flush(void) {
+    const size_t length = (m_spi_words_count / 8) * 9;
+    m_spi_transfer(m_spi_words, length);
+    memset(m_spi_words, 0, length);
+    m_spi_words_count = 0;
+}
+#endif
+
+/**
+ * Fills a rectangle of the local buffer, in panel coordinates.
+ * @param[in] x_panel The left edge of the rectangle, within the active area.
+ * @param[in] y_panel The top edge of the rectangle, within the active area.
+ * @param[in] w_panel The width of the rectangle, at least 1.
+ * @param[in] h_panel The height of the rectangle, at least 1.
+ * @param[in] color
+ */
+void sh1106::m_buffer_rectangle_fill(const size_t x_panel, const size_t y_panel, const size_t w_panel, const size_t h_panel, const uint16_t color) {
+    const size_t page_first = y_panel / 8;
+    const size_t page_last = (y_panel + h_panel - 1) / 8;
+    for (size_t page = page_first; page <= page_last; page++) {
+
+        /* Compute the rows of this page covered by the rectangle */
+        uint8_t mask = 0xFF;
+        if (page == page_first) mask &= 0xFF << (y_panel % 8);
+        if (page == page_last) mask &= 0xFF >> (7 - ((y_panel + h_panel - 1) % 8));
+
+        /* Apply to every column */
+        uint8_t* row = m_buffer_page(page);
+        if (row == NULL) {
+            continue;
+        }
+        row += x_panel;
+        if (mask == 0xFF) {
+            memset(row, color ? 0xFF : 0x00, w_panel);
+        } else if (color) {
+            for (size_t i = 0; i < w_panel; i++) row[i] |= mask;
+        } else {
+            for (size_t i = 0; i < w_panel; i++) row[i] &= ~mask;
+        }
+        m_dirty_mark(page, x_panel, x_panel + w_panel - 1);
+    }
+}
+
+/**
+ * Reads 8 vertically adjacent pixels of a bitmap, as a column byte with the top pixel in the lsb.
+ * @param[in] bitmap The bitmap data.
+ * @param[in] format The layout of the bitmap data.
+ * @param[in] w The width of the bitmap.
+ * @param[in] h The height of the bitmap.
+ * @param[in] column The column to read.
+ * @param[in] page The group of 8 rows to read, rows past the height of the bitmap read as 0.
+ * @return The column byte.
+ */
+uint8_t sh1106::m_bitmap_byte_get(const uint8_t* const bitmap, const enum bitmap_format format, const size_t w, const size_t h, const size_t column, const size_t page) {
+    if (format == BITMAP_FORMAT_PAGES) {
+        return bitmap[page * w + column];
+    }
+    const size_t stride = (w + 7) / 8;
+    const uint8_t* source = &bitmap[page * 8 * stride + column / 8];
+    const uint8_t bit = 0x80 >> (column % 8);
+    uint8_t byte = 0;
+    for (size_t k = 0; k < 8 && page * 8 + k < h; k++, source += stride) {
+        if (*source & bit) byte |= 1 << k;
+    }
+    return byte;
+}
+
+/**
+ * Draws a bitmap into the local buffer, at a position given in panel coordinates, working on whole column bytes.
+ * @param[in] x The column of the panel where the left of the bitmap goes, may be negative.
+ * @param[in] y The row of the panel where the top of the bitmap goes, may be negative.
+ * @param[in] bitmap The bitmap.
+ * @param[in] w The width of the bitmap.
+ * @param[in] h The height of the bitmap.
+ * @param[in] format The layout of the bitmap.
+ * @param[in] operation How the bitmap is combined with the buffer.
+ * @param[in] invert Mask applied to the bitmap bytes before combining them, 0xFF to use the bitmap inverted.
+ */
+void sh1106::m_buffer_bitmap_draw(const int16_t x, const int16_t y, const uint8_t* const bitmap, const int16_t w, const int16_t h, const enum bitmap_format format, const enum operation operation, const uint8_t invert) {
+    const int16_t column_first = (x < 0) ? -x : 0;
+    const int16_t column_last = (x + w > (int16_t)m_active_width) ? (int16_t)m_active_width - x - 1 : w - 1;
+    if (column_first > column_last) {
+        return;
+    }
+    for (int16_t page_source = 0; page_source < (h + 7) / 8; page_source++) {
+        const int16_t row = y + page_source * 8;
+        if (row + 8 <= 0 || row >= (int16_t)m_active_height) {
+            continue;
+        }
+        const uint8_t mask = (page_source == (h - 1) / 8 && h % 8 != 0) ? (0xFF >> (8 - (h % 8))) : 0xFF;
+        const int16_t page = (row >= 0) ? (row / 8) : -1;
+        const uint8_t shift = row - page * 8;
+        uint8_t* destination_low = (page >= 0) ? m_buffer_page(page) : NULL;
+        uint8_t* destination_high = (shift != 0) ? m_buffer_page(page + 1) : NULL;
+
+        /* Fast path for aligned copies of native bitmaps */
+        if (shift == 0 && mask == 0xFF && operation == OPERATION_COPY && format == BITMAP_FORMAT_PAGES && invert == 0x00) {
+            if (destination_low != NULL) {
+                memcpy(&destination_low[x + column_first], &bitmap[page_source * w + column_first], column_last - column_first + 1);
+                m_dirty_mark(page, x + column_first, x + column_last);
+            }
+            continue;
+        }
+
+        /* Shift and mask each column byte into one or two pages */
+        if (destination_low == NULL && destination_high == NULL) {
+            continue;
+        }
+        for (int16_t column = column_first; column <= column_last; column++) {
+            const uint8_t byte = (m_bitmap_byte_get(bitmap, format, w, h, column, page_source) ^ invert) & mask;
+            if (destination_low != NULL) {
+                m_operation_apply(destination_low[x + column], byte << shift, mask << shift, operation);
+            }
+            if (destination_high != NULL) {
+                m_operation_apply(destination_high[x + column], byte >> (8 - shift), mask >> (8 - shift), operation);
+            }
+        }
+        if (destination_low != NULL) {
+            m_dirty_mark(page, x + column_first, x + column_last);
+        }
+        if (destination_high != NULL) {
+            m_dirty_mark(page + 1, x + column_first, x + column_last);
+        }
+    }
+}
+
+/**
+ * Sends a run of decoded image bytes to the gdram, keeping the local buffer and the shadow buffer in sync with it.
+ * @param[in] page The page of the run.
+ * @param[in] column The first column of the run.
+ * @param[in] bytes The bytes of the run.
+ * @param[in] length The number of bytes of the run, which may be 0.
+ * @return 0 in case of success, or a negative error code otherwise.
+ */
+int sh1106::m_image_run_send(const size_t page, const size_t column, const uint8_t* const bytes, const size_t length) {
+    if (length == 0) {
+        return 0;
+    }
+    if (m_interface != INTERFACE_I2C_LIGHT && m_buffer_pages >= (m_active_height + 7) / 8) {
+        memcpy(&m_buffer[page * m_active_width + column], bytes, length);
+        if (m_shadow != NULL && m_shadow_valid) {
+            memcpy(&m_shadow[page * m_active_width + column], bytes, length);
+        }
+    }
+    return m_gdram_write(page, m_blanking_h + column, bytes, length);
+}
+
+/**
+ * Combines bits into a byte of display data.
+ * @param[in,out] destination The byte to modify.
+ * @param[in] source The new bits.
+ * @param[in] mask The bits of the byte that are affected.
+ * @param[in] operation How the new bits are combined with the current ones.
+ */
+void sh1106::m_operation_apply(uint8_t& destination, const uint8_t source, const uint8_t mask, const enum operation operation) {
+    switch (operation) {
+        case OPERATION_COPY: destination = (destination & ~mask) | (source & mask); break;
+        case OPERATION_OR: destination |= source & mask; break;
+        case OPERATION_AND: destination &= source | ~mask; break;
+        case OPERATION_XOR: destination ^= source & mask; break;
+    }
+}
+
+/**
+ * Resolves the current rotation once for a batch of pixels.
+ */
+struct sh1106::batch_rotation sh1106::m_batch_rotation(void) const {
+    struct batch_rotation batch;
+    batch.width = width();
+    batch.height = height();
+    batch.column_last = m_active_width - 1;
+    batch.row_last = m_active_height - 1;
+    batch.swap = (rotation & 1) != 0;
+    batch.mirror_x = (rotation == 1 || rotation == 2);
+    batch.mirror_y = (rotation >= 2);
+    return batch;
+}
+
+/**
+ * Clips a horizontal run of pixels to the screen, and converts it into a rectangle in panel coordinates.
+ * @return true if some of the run is on the screen.
+ */
+bool sh1106::m_span_rotation_handle(const struct batch_rotation& batch, const struct span& span, size_t& x_panel, size_t& y_panel, size_t& w_panel, size_t& h_panel) const {
+    const int32_t first = (span.x < 0) ? 0 : span.x;
+    int32_t last = (int32_t)span.x + span.w - 1;
+    if (last > (int32_t)batch.width - 1) last = batch.width - 1;
+    size_t x_first, y_first, x_last, y_last;
+    if (first > last || !batch.map(first, span.y, x_first, y_first) || !batch.map(last, span.y, x_last, y_last)) {
+        return false;
+    }
+    x_panel = (x_first < x_last) ? x_first : x_last;
+    y_panel = (y_first < y_last) ? y_first : y_last;
+    w_panel = ((x_first < x_last) ? x_last - x_first : x_first - x_last) + 1;
+    h_panel = ((y_first < y_last) ? y_last - y_first : y_first - y_last) + 1;
+    return true;
+}
+
+/**
+ * Converts a rectangle that fits on the screen from rotated coordinates into panel coordinates.
+ */
+void sh1106::m_rectangle_rotation_handle(const size_t x, const size_t y, const size_t w, const size_t h, size_t& x_panel, size_t& y_panel, size_t& w_panel, size_t& h_panel) const {
+    switch (rotation) {
+        case 1: {
+            x_panel = m_active_width - y - h;
+            y_panel = x;
+            w_panel = h;
+            h_panel = w;
+            break;
+        }
+        case 2: {
+            x_panel = m_active_width - x - w;
+            y_panel = m_active_height - y - h;
+            w_panel = w;
+            h_panel = h;
+            break;
+        }
+        case 3: {
+            x_panel = y;
+            y_panel = m_active_height - x - w;
+            w_panel = h;
+            h_panel = w;
+            break;
+        }
+        default: {
+            x_panel = x;
+            y_panel = y;
+            w_panel = w;
+            h_panel = h;
+            break;
+        }
+    }
+}
+
 /**
  *
  */
@@ -11,6 +11,47 @@
 #include <errno.h>
 #include <stdint.h>
 
+/* Project libraries */
+#include "sh1106_transport.h"
+
+/* Size of the wire library transmit buffer, which bounds the length of a single i2c transaction */
+#ifndef SH1106_I2C_BUFFER_LENGTH
+#if defined(I2C_BUFFER_LENGTH)
+#define SH1106_I2C_BUFFER_LENGTH I2C_BUFFER_LENGTH
+#elif defined(BUFFER_LENGTH)
+#define SH1106_I2C_BUFFER_LENGTH BUFFER_LENGTH
+#elif defined(WIRE_BUFFER_SIZE)
+#define SH1106_I2C_BUFFER_LENGTH WIRE_BUFFER_SIZE
+#else
+#define SH1106_I2C_BUFFER_LENGTH 32
+#endif
+#endif
+
+/* Number of gdram bytes remembered by the unbuffered i2c mode to avoid reading them back, or 0 to always read them back and save the memory */
+#ifndef SH1106_GDRAM_CACHE_SIZE
+#define SH1106_GDRAM_CACHE_SIZE 16
+#endif
+
+/* Highest spi clock accepted by setup(), can be raised for panels that are known to run faster */
+#ifndef SH1106_SPI_SPEED_MAX
+#define SH1106_SPI_SPEED_MAX 2000000
+#endif
+
+/* Number of groups of eight 9-bit words buffered before being sent in 3-wires spi, or 0 to leave out 3-wires spi support and its buffer */
+#ifndef SH1106_SPI_3WIRES_GROUPS
+#define SH1106_SPI_3WIRES_GROUPS 4
+#endif
+
+/* Set to 1, for example with a build flag, to count what is sent to the panel, see stats_get() */
+#ifndef SH1106_STATS
+#define SH1106_STATS 0
+#endif
+
+/* Number of glyphs the glyph cache can index, each taking a few bytes at the start of the cache buffer */
+#ifndef SH1106_GLYPH_CACHE_ENTRIES
+#define SH1106_GLYPH_CACHE_ENTRIES 32
+#endif
+
 /**
  *
  */
@@ -18,22 +59,114 @@ class sh1106 : public Adafruit_GFX {
 
    public:
     /* Setup */
-    sh1106(int width, int height) : Adafruit_GFX(width, height), m_active_width(width), m_active_height(height) {}
-    int setup(TwoWire& i2c_library, const uint8_t i2c_address, const int pin_res, uint8_t* const buffer);
+    sh1106(int width, int height) : Adafruit_GFX(width, height), m_active_width(width), m_active_height(height), m_blanking_h((width < 132) ? (132 - width) / 2 : 0) {}
+    int setup(TwoWire& i2c_library, const uint8_t i2c_address, const int pin_res, uint8_t* const buffer, const size_t buffer_pages = 0);
     int setup(TwoWire& i2c_library, const uint8_t i2c_address, const int pin_res);
-    int setup(SPIClass& spi_library, const int spi_speed, const int pin_cs, const int pin_dc, const int pin_res, uint8_t* const buffer);
+    int setup(SPIClass& spi_library, const int spi_speed, const int pin_cs, const int pin_dc, const int pin_res, uint8_t* const buffer, const size_t buffer_pages = 0);
+#if SH1106_SPI_3WIRES_GROUPS > 0
+    int setup(SPIClass& spi_library, const int spi_speed, const int pin_cs, const int pin_res, uint8_t* const buffer, const size_t buffer_pages = 0);
+#endif
+    int setup(sh1106_transport& transport, const int pin_res, uint8_t* const buffer, const size_t buffer_pages = 0);
     bool detect(void);
+    int column_offset_set(const size_t offset);
     int brightness_set(const float ratio);
     int inverted_set(const bool inverted);
     void invertDisplay(bool i);
+    int clock_set(const uint8_t divider, const uint8_t oscillator);
+    int multiplex_set(const uint8_t ratio);
+    int precharge_set(const uint8_t precharge, const uint8_t discharge);
 
     /* Pixel manipulation */
     int clear(void);
     int pixel_set(const size_t x, const size_t y, const uint16_t color);
     void drawPixel(int16_t x, int16_t y, uint16_t color);
+    int rectangle_fill(int16_t x, int16_t y, int16_t w, int16_t h, const uint16_t color);
+    void drawFastHLine(int16_t x, int16_t y, int16_t w, uint16_t color);
+    void drawFastVLine(int16_t x, int16_t y, int16_t h, uint16_t color);
+    void fillRect(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color);
+    void fillScreen(uint16_t color);
+
+    /* Bitmaps */
+    enum bitmap_format {
+        BITMAP_FORMAT_PAGES,  //!< Column bytes in the layout of the gdram, 8 rows per byte with the top row in the lsb.
+        BITMAP_FORMAT_ROWS,   //!< Rows of bits packed msb first, each row padded to a byte, as used by Adafruit_GFX.
+    };
+    enum operation {
+        OPERATION_COPY,
+        OPERATION_OR,
+        OPERATION_AND,
+        OPERATION_XOR,
+    };
+    int bitmap_draw(const int16_t x, const int16_t y, const uint8_t* const bitmap, const int16_t w, const int16_t h, const enum bitmap_format format, const enum operation operation);
+
+    /* Batches */
+    struct point {
+        int16_t x;
+        int16_t y;
+    };
+    struct span {
+        int16_t x;  //!< Left end of the run.
+        int16_t y;
+        int16_t w;  //!< Length of the run, towards the right.
+    };
+    int points_set(const struct point* const points, const size_t count, const uint16_t color);
+    int spans_set(const struct span* const spans, const size_t count, const uint16_t color);
+    int scanlines_draw(const int16_t x, const int16_t y, const uint8_t* const bits, const int16_t w, const int16_t h, const uint16_t color);
+
+    /* Compressed images */
+    int image_draw(const uint8_t* const image);
+    int animation_play(const uint8_t* const animation, size_t& position);
 
     /* Output */
     int display(void);
+    int display_begin(void);
+    int display_poll(void);
+    int invalidate(void);
+    int render(void (*callback)(sh1106& display, void* context), void* context);
+    int frames_set(uint8_t* const buffer_second, uint8_t* const buffer_third);
+    int frame_submit(void);
+    int frame_flush(void);
+    int shadow_set(uint8_t* const shadow);
+    int frame_rate_set(const float fps);  // display() then returns 1 when it defers a transfer, and should be called again
+
+    /* Scrolling */
+    int scroll_up(void);
+    int scroll_left(const size_t page, const size_t pages);
+
+    /* Grayscale */
+    struct grayscale_timing {
+        uint32_t cycles;       //!< Complete cycles of bit-planes shown.
+        uint32_t cycle_us;     //!< Duration in microseconds of the last complete cycle.
+        uint32_t transfer_us;  //!< Duration in microseconds of the last transfer of a bit-plane.
+        uint32_t overruns;     //!< Transfers of a bit-plane that did not complete within their slot.
+    };
+    int grayscale_set(uint8_t* const planes, const uint32_t slot_us, const bool contrast_modulated = false, const uint8_t frequency = 0);
+    int grayscale_poll(void);
+    const struct grayscale_timing& grayscale_timing_get(void) const;
+
+    /* Text */
+    int console_set(const bool enabled);
+    int glyph_cache_set(uint8_t* const cache, const size_t size);
+    size_t write(uint8_t c);
+
+#if SH1106_STATS
+    /* Instrumentation */
+    struct stats {
+        uint32_t bytes_command;       //!< Command bytes sent, including gdram addressing.
+        uint32_t bytes_data;          //!< Display data bytes sent.
+        uint32_t bytes_read;          //!< Display data bytes read back, in unbuffered i2c mode.
+        uint32_t transactions;        //!< Bus transactions: i2c transmissions and requests, or spi chip select windows.
+        uint32_t round_trips;         //!< Read-modify-write round trips to the gdram, in unbuffered i2c mode.
+        uint32_t errors;              //!< Failed transactions, such as i2c nacks.
+        uint32_t frames;              //!< Transfers of the local buffer completed.
+        uint32_t frame_bytes;         //!< Bytes sent by the last transfer of the local buffer.
+        uint32_t frame_transactions;  //!< Bus transactions of the last transfer of the local buffer.
+        uint32_t frame_us;            //!< Duration in microseconds of the last transfer of the local buffer, from display_begin() to completion.
+        uint32_t page_us[8];          //!< Time in microseconds spent on the bus for each page by the last transfer of the local buffer.
+    };
+    const struct stats& stats_get(void) const;
+    void stats_reset(void);
+#endif
 
     /* Commands */
     enum command {
@@ -63,32 +196,147 @@ class sh1106 : public Adafruit_GFX {
         COMMAND_VCOMH_DESELECT_LEVEL_SET = 0xDB,
         COMMAND_READWRITEMODIFY_BEGIN = 0xE0,
         COMMAND_READWRITEMODIFY_END = 0xEE,
+        COMMAND_NOP = 0xE3,
     };
     int command_send(const uint8_t command);
     int command_send(const uint8_t command, const uint8_t parameter);
+    int commands_send(const uint8_t* const commands, const size_t length);
     int data_send(const uint8_t data);
     int data_send(uint8_t* const data, const size_t length);
 
    protected:
+    friend class sh1106_compositor;
     const size_t m_gdram_width = 132, m_gdram_height = 64;  //!<
     size_t m_active_width, m_active_height;                 //!<
-    size_t m_blanking_h;                                    //!< Number of empty pixel columns, starting from the left.
+    size_t m_blanking_h;                                    //!< Number of gdram columns before the first visible one, which depends on how the panel is wired.
     TwoWire* m_i2c_library = NULL;
     uint8_t m_i2c_address = 0;
     SPIClass* m_spi_library = NULL;
+    sh1106_transport* m_transport = NULL;
     SPISettings m_spi_settings;
     int m_pin_cs = 0;
     int m_pin_dc = 0;
+    bool m_spi_dc = false;      //!< Current level of the data/command pin.
+    size_t m_window_depth = 0;  //!< Number of nested transfer windows currently open.
+#if SH1106_SPI_3WIRES_GROUPS > 0
+    uint8_t m_spi_words[SH1106_SPI_3WIRES_GROUPS * 9];  //!< In 3-wires spi, 9-bit words waiting to be sent, packed eight words per nine bytes.
+    size_t m_spi_words_count = 0;                       //!< Number of words in m_spi_words.
+#endif
     uint8_t* m_buffer = NULL;
+    size_t m_buffer_pages = 0;       //!< Number of pages the local buffer holds.
+    size_t m_buffer_page_first = 0;  //!< First page of the panel held by the local buffer, when it only holds a strip.
+    uint8_t m_dirty_min[8];  //!< For each page, first column of the local buffer that differs from the gdram.
+    uint8_t m_dirty_max[8];  //!< For each page, last column of the local buffer that differs from the gdram, lower than the first one if the page is clean.
+    size_t m_scroll_pages = 0;  //!< Number of pages the gdram start line has been moved by.
+    bool m_console = false;     //!< Whether printing past the bottom of the screen scrolls it.
+    uint8_t* m_shadow = NULL;    //!< Optional copy of the last frame sent to the gdram, used to only send bytes that changed.
+    bool m_shadow_valid = false;  //!< Whether the shadow buffer matches the gdram.
+    uint32_t m_frame_interval = 0;  //!< Minimum time between the start of two transfers started by display(), in microseconds, or 0 for no limit.
+    uint32_t m_frame_last = 0;      //!< Time at which display() last started a transfer.
+    bool m_flush_active = false;             //!< Whether a transfer started with display_begin() is in progress.
+    bool m_flush_shadow_validates = false;   //!< Whether the transfer in progress will bring the shadow buffer in sync with the gdram.
+    size_t m_flush_page = 0;                 //!< Page being sent.
+    size_t m_flush_page_next = 0;            //!< Next page to look at once the current one is sent.
+    size_t m_flush_column = 0;               //!< Next column of the page to send.
+    size_t m_flush_column_end = 0;           //!< Column after the last one of the page to send.
+    bool m_flush_full = false;               //!< Whether the transfer in progress sends whole pages instead of the dirty ranges.
+    const uint8_t* m_flush_buffer = NULL;    //!< Buffer the transfer in progress is sent from.
+    uint8_t m_contrast = 0x80;                       //!< Contrast set with brightness_set().
+    uint8_t m_frequency = 0x80;                      //!< Display clock divider and oscillator frequency.
+    uint8_t* m_grayscale = NULL;                     //!< In grayscale mode, the low then the high bit-plane, each laid out as the local buffer.
+    uint32_t m_grayscale_slot_us = 0;                //!< Time each slot of a grayscale cycle lasts.
+    bool m_grayscale_contrast = false;               //!< Whether bit-planes are weighted by contrast instead of by time.
+    uint8_t m_grayscale_slot = 0;                    //!< Slot of the grayscale cycle being shown.
+    uint32_t m_grayscale_slot_start = 0;             //!< Time at which the current slot started.
+    uint32_t m_grayscale_cycle_start = 0;            //!< Time at which the current cycle started.
+    uint32_t m_grayscale_transfer_start = 0;         //!< Time at which the transfer of the current bit-plane started.
+    struct grayscale_timing m_grayscale_timing = {};  //!< Timing reported by grayscale_timing_get().
+    uint8_t* m_frames[3] = {NULL, NULL, NULL};  //!< When drawing and sending from different threads, the three buffers frames rotate through.
+    uint8_t m_frame_render = 0;                 //!< Index of the buffer being drawn, owned by the drawing side.
+    uint8_t m_frame_flush = 0;                  //!< Index of the buffer being sent, owned by the sending side.
+    uint8_t m_frame_ready = 0;                  //!< Index of the latest completed frame, exchanged atomically between both sides, with FRAME_READY_NEW set until it is taken.
+    static const uint8_t FRAME_READY_NEW = 0x80;
+#if SH1106_GDRAM_CACHE_SIZE > 0
+    struct gdram_cache_entry {
+        uint16_t tag;   //!< Page and column of the cached byte plus one, or 0 if the entry is empty.
+        uint8_t value;  //!< Cached gdram byte.
+    } m_gdram_cache[SH1106_GDRAM_CACHE_SIZE];  //!< In unbuffered mode, direct-mapped cache of recently accessed gdram bytes.
+    static uint16_t m_gdram_cache_tag(const size_t page, const size_t column) {
+        return page * 132 + column + 1;
+    }
+#endif
+    void m_gdram_cache_clear(void);
+    struct glyph_entry {
+        const GFXfont* font;  //!< Font of the glyph, or NULL for the built-in one.
+        uint16_t offset;      //!< Position of the glyph bitmap in the data area.
+        uint8_t character;    //!< Character code.
+        uint8_t size_x;       //!< Horizontal text size, or 0 if the entry is empty.
+        uint8_t size_y;       //!< Vertical text size.
+        uint8_t rotation;     //!< Rotation the bitmap was converted for, plus 4 when in cp437 mode.
+    }* m_glyph_entries = NULL;         //!< Direct-mapped index of the glyph cache, at the start of the cache buffer.
+    uint8_t* m_glyph_data = NULL;      //!< Glyph bitmaps, in panel orientation and page format, after the index.
+    size_t m_glyph_data_size = 0;      //!< Size of the glyph data area.
+    size_t m_glyph_data_used = 0;      //!< Number of bytes of the glyph data area already allocated.
+
+#if SH1106_STATS
+    struct stats m_stats = {};                  //!< Counters reported by stats_get().
+    uint32_t m_stats_frame_start = 0;           //!< Time at which the transfer in progress started.
+    uint32_t m_stats_frame_bytes = 0;           //!< Bytes sent before the transfer in progress started.
+    uint32_t m_stats_frame_transactions = 0;    //!< Bus transactions before the transfer in progress started.
+    void m_stats_frame_begin(void);
+#endif
 
     enum interface {
         INTERFACE_NONE,
         INTERFACE_I2C_BUFFERED,
-        INTERFACE_I2C_LIGHT,   // TODO
-        INTERFACE_SPI_4WIRES,  // TODO
-        INTERFACE_SPI_3WIRES,  // TODO
+        INTERFACE_I2C_LIGHT,
+        INTERFACE_SPI_4WIRES,
+        INTERFACE_SPI_3WIRES,
+        INTERFACE_TRANSPORT,
     } m_interface = INTERFACE_NONE;
+    void m_window_open(void);
+    void m_window_close(void);
+    static size_t m_command_length(const uint8_t command);
+    int m_spi_write(const bool dc, const uint8_t* const bytes, const size_t length);
+    void m_spi_transfer(const uint8_t* const bytes, const size_t length);
+#if SH1106_SPI_3WIRES_GROUPS > 0
+    void m_spi_word_push(const bool dc, const uint8_t byte);
+    void m_spi_words_flush(void);
+#endif
     int m_rotation_handle(const size_t x, const size_t y, size_t& x_panel, size_t& y_panel) const;
+    struct batch_rotation {
+        size_t width, height;           //!< Size of the screen, as drawn.
+        size_t column_last, row_last;   //!< Last column and row of the panel.
+        bool swap, mirror_x, mirror_y;  //!< Steps turning drawn coordinates into panel coordinates.
+        bool map(const int16_t x, const int16_t y, size_t& x_panel, size_t& y_panel) const {
+            if ((size_t)(uint16_t)x >= width || (size_t)(uint16_t)y >= height) return false;
+            x_panel = swap ? y : x;
+            y_panel = swap ? x : y;
+            if (mirror_x) x_panel = column_last - x_panel;
+            if (mirror_y) y_panel = row_last - y_panel;
+            return true;
+        }
+    };
+    struct batch_rotation m_batch_rotation(void) const;
+    bool m_span_rotation_handle(const struct batch_rotation& batch, const struct span& span, size_t& x_panel, size_t& y_panel, size_t& w_panel, size_t& h_panel) const;
+    static uint8_t m_bitmap_byte_get(const uint8_t* const bitmap, const enum bitmap_format format, const size_t w, const size_t h, const size_t column, const size_t page);
+    static void m_operation_apply(uint8_t& destination, const uint8_t source, const uint8_t mask, const enum operation operation);
+    void m_rectangle_rotation_handle(const size_t x, const size_t y, const size_t w, const size_t h, size_t& x_panel, size_t& y_panel, size_t& w_panel, size_t& h_panel) const;
+    void m_buffer_rectangle_fill(const size_t x_panel, const size_t y_panel, const size_t w_panel, const size_t h_panel, const uint16_t color);
+    void m_buffer_bitmap_draw(const int16_t x_panel, const int16_t y_panel, const uint8_t* const bitmap, const int16_t w, const int16_t h, const enum bitmap_format format, const enum operation operation, const uint8_t invert);
+    int m_glyph_write(const uint8_t c);
+    int m_panel_init(const int pin_res);
+    uint8_t* m_buffer_page(const size_t page) const;
+    void m_dirty_mark(const size_t page, const size_t column_min, const size_t column_max);
+    void m_dirty_mark_all(void);
+    int m_flush_step(const bool bounded);
+    void m_flush_start(const uint8_t* const buffer);
+    bool m_run_find(const size_t page, const size_t column_start, const size_t column_end, size_t& run_start, size_t& run_stop) const;
+    int m_gdram_write(const size_t page, const size_t column, const uint8_t* const data, const size_t length);
+    int m_gdram_read(const size_t page, const size_t column, uint8_t* const data, const size_t length);
+    int m_gdram_span_modify(const size_t page, const size_t column_first, const size_t column_last, const uint8_t mask, const uint16_t color, const uint8_t* const masks = NULL);
+    int m_gdram_masks_apply(const size_t page, const uint8_t* const masks, const uint16_t color);
+    int m_image_run_send(const size_t page, const size_t column, const uint8_t* const bytes, const size_t length);
 };
 
 #endif
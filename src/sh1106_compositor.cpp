@@ -0,0 +1,212 @@
+/* Self header */
+#include "sh1106_compositor.h"
+
+/**
+ * Attaches the compositor to a panel, and schedules the whole screen to be composed.
+ * @param[in] panel The panel, set up with a local buffer holding the whole screen.
+ * @param[in] background The background, laid out as the local buffer, or NULL for a blank one.
+ * @return 0 in case of success, or a negative error code otherwise.
+ */
+int sh1106_compositor::setup(sh1106& panel, const uint8_t* const background) {
+    if (panel.m_buffer == NULL || panel.m_buffer_pages < (panel.m_active_height + 7) / 8) {
+        return -EINVAL;
+    }
+    m_panel = &panel;
+    for (size_t i = 0; i < SH1106_COMPOSITOR_SPRITES; i++) {
+        m_sprites[i] = {};
+    }
+    return background_set(background);
+}
+
+/**
+ * Replaces the background, and schedules the whole screen to be composed again.
+ * @param[in] background The background, laid out as the local buffer, or NULL for a blank one.
+ * @return 0 in case of success, or a negative error code otherwise.
+ */
+int sh1106_compositor::background_set(const uint8_t* const background) {
+    if (m_panel == NULL) {
+        return -EINVAL;
+    }
+    m_background = background;
+    memset(m_dirty_min, 0xFF, sizeof(m_dirty_min));
+    memset(m_dirty_max, 0, sizeof(m_dirty_max));
+    m_dirty_mark(0, 0, m_panel->m_active_width, m_panel->m_active_height);
+    return 0;
+}
+
+/**
+ * Sets the content of a sprite, keeping its position and visibility. New sprites are hidden, at the top left corner.
+ * This should also be called when the content of the bitmap or mask changed.
+ * @param[in] index The index of the sprite, sprites with a higher index being drawn over the others.
+ * @param[in] bitmap The bitmap in page format (for each group of 8 rows, one byte per column with the top row in the lsb), or NULL to remove the sprite.
+ * @param[in] mask Optionally, a bitmap in the same format of the pixels to clear before the rule is applied, which makes the sprite opaque there.
+ * @param[in] w The width of the sprite.
+ * @param[in] h The height of the sprite.
+ * @param[in] rule How the sprite is combined with what is under it.
+ * @return 0 in case of success, or a negative error code otherwise.
+ */
+int sh1106_compositor::sprite_set(const size_t index, const uint8_t* const bitmap, const uint8_t* const mask, const uint8_t w, const uint8_t h, const enum rule rule) {
+    if (m_panel == NULL || index >= SH1106_COMPOSITOR_SPRITES) {
+        return -EINVAL;
+    }
+    struct sprite& sprite = m_sprites[index];
+    if (sprite.bitmap != NULL && sprite.visible) {
+        m_dirty_mark(sprite.x, sprite.y, sprite.w, sprite.h);
+    }
+    sprite.bitmap = bitmap;
+    sprite.mask = mask;
+    sprite.w = w;
+    sprite.h = h;
+    sprite.rule = rule;
+    if (sprite.bitmap != NULL && sprite.visible) {
+        m_dirty_mark(sprite.x, sprite.y, sprite.w, sprite.h);
+    }
+    return 0;
+}
+
+/**
+ * Moves a sprite, only the area it leaves and the area it covers being composed again.
+ * @param[in] index The index of the sprite.
+ * @param[in] x The column of the panel where the left of the sprite goes, may be negative.
+ * @param[in] y The row of the panel where the top of the sprite goes, may be negative.
+ * @return 0 in case of success, or a negative error code otherwise.
+ */
+int sh1106_compositor::sprite_move(const size_t index, const int16_t x, const int16_t y) {
+    if (m_panel == NULL || index >= SH1106_COMPOSITOR_SPRITES) {
+        return -EINVAL;
+    }
+    struct sprite& sprite = m_sprites[index];
+    if (sprite.x == x && sprite.y == y) {
+        return 0;
+    }
+    if (sprite.bitmap != NULL && sprite.visible) {
+        m_dirty_mark(sprite.x, sprite.y, sprite.w, sprite.h);
+        m_dirty_mark(x, y, sprite.w, sprite.h);
+    }
+    sprite.x = x;
+    sprite.y = y;
+    return 0;
+}
+
+/**
+ * Shows or hides a sprite.
+ * @param[in] index The index of the sprite.
+ * @param[in] visible
+ * @return 0 in case of success, or a negative error code otherwise.
+ */
+int sh1106_compositor::sprite_show(const size_t index, const bool visible) {
+    if (m_panel == NULL || index >= SH1106_COMPOSITOR_SPRITES) {
+        return -EINVAL;
+    }
+    struct sprite& sprite = m_sprites[index];
+    if (sprite.visible != visible && sprite.bitmap != NULL) {
+        m_dirty_mark(sprite.x, sprite.y, sprite.w, sprite.h);
+    }
+    sprite.visible = visible;
+    return 0;
+}
+
+/**
+ * Composes the regions where sprites changed into the local buffer of the panel, and marks them to be sent by the next call to display().
+ * For each page, the range of columns that changed is copied from the background, then the visible sprites that overlap it are applied in order.
+ * @return 0 in case of success, or a negative error code otherwise.
+ */
+int sh1106_compositor::compose(void) {
+
+    /* Ensure the local buffer still holds the whole screen, and is the one being shown */
+    if (m_panel == NULL || m_panel->m_buffer == NULL || m_panel->m_buffer_pages < (m_panel->m_active_height + 7) / 8 || m_panel->m_frames[0] != NULL || m_panel->m_grayscale != NULL) {
+        return -EINVAL;
+    }
+
+    const size_t width = m_panel->m_active_width;
+    for (size_t page = 0; page < (m_panel->m_active_height + 7) / 8; page++) {
+        if (m_dirty_min[page] > m_dirty_max[page]) {
+            continue;
+        }
+        const int16_t first = m_dirty_min[page], last = m_dirty_max[page];
+        uint8_t* row = &m_panel->m_buffer[page * width];
+
+        /* Start from the background */
+        if (m_background != NULL) {
+            memcpy(&row[first], &m_background[page * width + first], last - first + 1);
+        } else {
+            memset(&row[first], 0, last - first + 1);
+        }
+
+        /* Apply the sprites over it */
+        for (size_t i = 0; i < SH1106_COMPOSITOR_SPRITES; i++) {
+            const struct sprite& sprite = m_sprites[i];
+            const int16_t top = page * 8 - sprite.y;  // Row of the sprite at the top of the page
+            if (sprite.bitmap == NULL || !sprite.visible || top <= -8 || top >= sprite.h) {
+                continue;
+            }
+            const int16_t column_first = (sprite.x > first) ? sprite.x : first;
+            const int16_t column_last = (sprite.x + sprite.w - 1 < last) ? sprite.x + sprite.w - 1 : last;
+            for (int16_t column = column_first; column <= column_last; column++) {
+                uint8_t& destination = row[column];
+                if (sprite.mask != NULL) {
+                    destination &= ~m_sprite_byte_get(sprite.mask, sprite.w, sprite.h, column - sprite.x, top);
+                }
+                const uint8_t bits = m_sprite_byte_get(sprite.bitmap, sprite.w, sprite.h, column - sprite.x, top);
+                switch (sprite.rule) {
+                    case RULE_OR: destination |= bits; break;
+                    case RULE_AND_NOT: destination &= ~bits; break;
+                    case RULE_XOR: destination ^= bits; break;
+                }
+            }
+        }
+
+        /* Hand the range over to the panel */
+        m_panel->m_dirty_mark(page, first, last);
+        m_dirty_min[page] = 0xFF;
+        m_dirty_max[page] = 0;
+    }
+    return 0;
+}
+
+/**
+ * Extends the ranges of columns to compose again with a rectangle, clipped to the screen.
+ */
+void sh1106_compositor::m_dirty_mark(const int16_t x, const int16_t y, const int16_t w, const int16_t h) {
+    const int16_t width = m_panel->m_active_width, height = m_panel->m_active_height;
+    const int16_t left = (x < 0) ? 0 : x;
+    const int16_t right = (x + w > width) ? width - 1 : x + w - 1;
+    const int16_t top = (y < 0) ? 0 : y;
+    const int16_t bottom = (y + h > height) ? height - 1 : y + h - 1;
+    if (left > right || top > bottom) {
+        return;
+    }
+    for (int16_t page = top / 8; page <= bottom / 8; page++) {
+        if (left < m_dirty_min[page]) m_dirty_min[page] = left;
+        if (right > m_dirty_max[page]) m_dirty_max[page] = right;
+    }
+}
+
+/**
+ * Reads 8 vertically adjacent pixels of a sprite, as a column byte with the top pixel in the lsb.
+ * @param[in] bitmap The bitmap, in page format.
+ * @param[in] w The width of the bitmap.
+ * @param[in] h The height of the bitmap.
+ * @param[in] column The column to read.
+ * @param[in] row The top row to read, may be negative. Rows outside of the bitmap read as 0.
+ * @return The column byte.
+ */
+uint8_t sh1106_compositor::m_sprite_byte_get(const uint8_t* const bitmap, const uint8_t w, const uint8_t h, const size_t column, const int16_t row) {
+    if (row <= -8 || row >= h) {
+        return 0x00;
+    }
+    uint8_t byte;
+    if (row < 0) {
+        byte = bitmap[column] << -row;
+    } else {
+        const size_t page = row / 8, shift = row % 8;
+        byte = bitmap[page * w + column] >> shift;
+        if (shift != 0 && (page + 1) * 8 < h) {
+            byte |= bitmap[(page + 1) * w + column] << (8 - shift);
+        }
+    }
+    if (h - row < 8) {
+        byte &= 0xFF >> (8 - (h - row));
+    }
+    return byte;
+}
@@ -0,0 +1,48 @@
+#ifndef SH1106_COMPOSITOR_H
+#define SH1106_COMPOSITOR_H
+
+/* Project libraries */
+#include "sh1106.h"
+
+/* Maximum number of sprites a compositor can handle */
+#ifndef SH1106_COMPOSITOR_SPRITES
+#define SH1106_COMPOSITOR_SPRITES 8
+#endif
+
+/**
+ * Composes sprites over a static background into the local buffer of a panel, only recomposing the regions where sprites changed.
+ * Sprites are drawn in order of their index over the background, in panel coordinates regardless of rotation. The compositor owns the local buffer: whatever is drawn into it directly is overwritten when the region it lies in is recomposed.
+ */
+class sh1106_compositor {
+
+   public:
+    enum rule {
+        RULE_OR,       //!< Lights the pixels set in the sprite.
+        RULE_AND_NOT,  //!< Turns off the pixels set in the sprite.
+        RULE_XOR,      //!< Inverts the pixels set in the sprite.
+    };
+    int setup(sh1106& panel, const uint8_t* const background);
+    int background_set(const uint8_t* const background);
+    int sprite_set(const size_t index, const uint8_t* const bitmap, const uint8_t* const mask, const uint8_t w, const uint8_t h, const enum rule rule);
+    int sprite_move(const size_t index, const int16_t x, const int16_t y);
+    int sprite_show(const size_t index, const bool visible);
+    int compose(void);
+
+   protected:
+    sh1106* m_panel = NULL;
+    const uint8_t* m_background = NULL;  //!< Background, laid out as the local buffer, or NULL for a blank one.
+    struct sprite {
+        const uint8_t* bitmap;  //!< Bitmap in page format, or NULL if the sprite is not set.
+        const uint8_t* mask;    //!< Optional bitmap of the pixels cleared before the rule is applied, in page format.
+        int16_t x, y;           //!< Position of the top left corner on the panel.
+        uint8_t w, h;           //!< Size of the sprite.
+        enum rule rule;         //!< How the sprite is combined with what is under it.
+        bool visible;           //!< Whether the sprite is shown.
+    } m_sprites[SH1106_COMPOSITOR_SPRITES] = {};
+    uint8_t m_dirty_min[8];  //!< For each page, first column to recompose.
+    uint8_t m_dirty_max[8];  //!< For each page, last column to recompose, lower than the first one if there is none.
+    void m_dirty_mark(const int16_t x, const int16_t y, const int16_t w, const int16_t h);
+    static uint8_t m_sprite_byte_get(const uint8_t* const bitmap, const uint8_t w, const uint8_t h, const size_t column, const int16_t row);
+};
+
+#endif
@@ -0,0 +1,289 @@
+/* Self header */
+#include "sh1106_emulator.h"
+
+/* C/C++ libraries */
+#include <errno.h>
+#include <stdio.h>
+#include <string.h>
+
+/**
+ * Brings the model back to the state of the controller after a hardware reset, with an undefined gdram shown as cleared.
+ */
+void sh1106_emulator::reset(void) {
+    memset(m_gdram, 0, sizeof(m_gdram));
+    m_page = 0;
+    m_column = 0;
+    m_rmw = false;
+    m_rmw_column = 0;
+    m_startline = 0;
+    m_offset = 0;
+    m_multiplex = 63;
+    m_remap = false;
+    m_scan_decreasing = false;
+    m_inverted = false;
+    m_entire_on = false;
+    m_on = false;
+    m_contrast = 0x80;
+    m_parameter_command = 0;
+    m_read_dummy = true;
+}
+
+/**
+ * Receives bytes the way a 4-wires spi bus would deliver them, which is also what sh1106 sends through a transport.
+ * @param[in] dc false for commands, true for display data.
+ * @param[in] bytes The bytes, or NULL for zeros.
+ * @param[in] length The number of bytes.
+ * @return 0, the model accepting any stream.
+ */
+int sh1106_emulator::write(const bool dc, const uint8_t* const bytes, const size_t length) {
+    for (size_t i = 0; i < length; i++) {
+        const uint8_t byte = (bytes != NULL) ? bytes[i] : 0x00;
+        if (dc) {
+            m_data(byte);
+        } else {
+            m_command(byte);
+        }
+    }
+    return 0;
+}
+
+/**
+ * Receives an i2c write transaction, decoding the control bytes that tell commands from data.
+ * @param[in] bytes The bytes of the transaction, after the address.
+ * @param[in] length The number of bytes.
+ * @return 0 in case of success, or a negative error code if the transaction is malformed.
+ */
+int sh1106_emulator::i2c_receive(const uint8_t* const bytes, const size_t length) {
+    size_t i = 0;
+    while (i < length) {
+        const uint8_t control = bytes[i++];
+        if ((control & 0x3F) != 0) {
+            return -EINVAL;
+        }
+        const bool continuation = (control & 0x80) != 0;  // Co: a single byte follows, then another control byte
+        const bool dc = (control & 0x40) != 0;
+        const size_t count = continuation ? 1 : (length - i);
+        if (continuation && i >= length) {
+            return -EINVAL;
+        }
+        write(dc, &bytes[i], count);
+        i += count;
+    }
+    return 0;
+}
+
+/**
+ * Answers an i2c read request with display data, starting with the dummy byte the controller sends after the address was set.
+ * @param[out] bytes The bytes read.
+ * @param[in] length The number of bytes requested.
+ */
+void sh1106_emulator::i2c_request(uint8_t* const bytes, const size_t length) {
+    for (size_t i = 0; i < length; i++) {
+        if (m_read_dummy) {
+            m_read_dummy = false;
+            bytes[i] = 0x00;
+            continue;
+        }
+        bytes[i] = (m_page < 8 && m_column < 132) ? m_gdram[m_page][m_column] : 0x00;
+        if (!m_rmw) {
+            m_column++;
+        }
+    }
+}
+
+/**
+ * Retrieves a byte of the gdram.
+ * @param[in] page The page, from 0 to 7.
+ * @param[in] column The column, from 0 to 131.
+ * @return The byte, the least significant bit being the top row.
+ */
+uint8_t sh1106_emulator::gdram_get(const size_t page, const size_t column) const {
+    if (page >= 8 || column >= 132) {
+        return 0x00;
+    }
+    return m_gdram[page][column];
+}
+
+/**
+ * Tells whether a pixel of the panel is lit, taking into account the start line, display offset, remap, scan direction, inversion and power state.
+ * Coordinates are those sh1106 draws with, without rotation. With other remap or scan direction settings than the ones it sends, the image comes out mirrored, as it would on the panel.
+ * @param[in] x The column of the panel.
+ * @param[in] y The row of the panel.
+ * @return true if the pixel is lit.
+ */
+bool sh1106_emulator::pixel_get(const int x, const int y) const {
+    if (x < 0 || y < 0 || x >= m_width || y >= m_height || !m_on) {
+        return false;
+    }
+    if (m_entire_on) {
+        return true;
+    }
+    const int com = m_scan_decreasing ? y : (m_height - 1 - y);
+    if (com > m_multiplex) {
+        return false;
+    }
+    const int row = (com + m_startline + m_offset) % 64;
+    const int column = m_remap ? (x + m_column_offset) : (131 - x - m_column_offset);
+    if (column < 0 || column >= 132) {
+        return false;
+    }
+    const bool lit = (m_gdram[row / 8][column] >> (row % 8)) & 1;
+    return lit != m_inverted;
+}
+
+/**
+ * Exports what the panel shows as a binary pbm image, lit pixels being white.
+ * @param[out] pbm The buffer receiving the image, or NULL to only compute its size.
+ * @param[in] size The size of the buffer.
+ * @return The size of the image, which was only written if it fits in the buffer.
+ */
+size_t sh1106_emulator::pbm_export(uint8_t* const pbm, const size_t size) const {
+    char header[16];
+    const size_t header_length = snprintf(header, sizeof(header), "P4\n%d %d\n", m_width, m_height);
+    const size_t stride = (m_width + 7) / 8;
+    const size_t length = header_length + stride * m_height;
+    if (pbm == NULL || size < length) {
+        return length;
+    }
+    memcpy(pbm, header, header_length);
+    uint8_t* row = &pbm[header_length];
+    for (int y = 0; y < m_height; y++, row += stride) {
+        memset(row, 0, stride);
+        for (int x = 0; x < m_width; x++) {
+            if (!pixel_get(x, y)) {
+                row[x / 8] |= 0x80 >> (x % 8);  // In pbm, 1 is black
+            }
+        }
+    }
+    return length;
+}
+
+/**
+ * Compares what the panel shows against a golden pbm image, lit pixels being white.
+ * @param[in] pbm The image, in the binary (P4) or plain (P1) pbm format.
+ * @param[in] length The size of the image.
+ * @param[out] mismatches Optionally, the number of pixels that differ.
+ * @return 0 if the panel shows the image, 1 if it does not, or a negative error code if the image is malformed or of another size.
+ */
+int sh1106_emulator::pbm_compare(const uint8_t* const pbm, const size_t length, size_t* const mismatches) const {
+
+    /* Parse header */
+    if (pbm == NULL || length < 2 || pbm[0] != 'P' || (pbm[1] != '1' && pbm[1] != '4')) {
+        return -EINVAL;
+    }
+    const bool binary = (pbm[1] == '4');
+    size_t i = 2;
+    int fields[2];
+    for (size_t f = 0; f < 2; f++) {
+        while (i < length && (pbm[i] == ' ' || pbm[i] == '\t' || pbm[i] == '\r' || pbm[i] == '\n' || pbm[i] == '#')) {
+            if (pbm[i] == '#') {
+                while (i < length && pbm[i] != '\n') i++;
+            } else {
+                i++;
+            }
+        }
+        if (i >= length || pbm[i] < '0' || pbm[i] > '9') {
+            return -EINVAL;
+        }
+        fields[f] = 0;
+        while (i < length && pbm[i] >= '0' && pbm[i] <= '9') {
+            fields[f] = fields[f] * 10 + (pbm[i++] - '0');
+        }
+    }
+    if (fields[0] != m_width || fields[1] != m_height) {
+        return -EINVAL;
+    }
+    i++;  // Single whitespace before the raster
+
+    /* Compare pixels */
+    size_t count = 0;
+    const size_t stride = (m_width + 7) / 8;
+    for (int y = 0; y < m_height; y++) {
+        for (int x = 0; x < m_width; x++) {
+            bool black;
+            if (binary) {
+                const size_t index = i + y * stride + x / 8;
+                if (index >= length) {
+                    return -EINVAL;
+                }
+                black = (pbm[index] >> (7 - (x % 8))) & 1;
+            } else {
+                while (i < length && pbm[i] != '0' && pbm[i] != '1') i++;
+                if (i >= length) {
+                    return -EINVAL;
+                }
+                black = (pbm[i++] == '1');
+            }
+            if (black == pixel_get(x, y)) {
+                count++;
+            }
+        }
+    }
+    if (mismatches != NULL) {
+        *mismatches = count;
+    }
+    return (count == 0) ? 0 : 1;
+}
+
+/**
+ * Executes a command byte, or stores it as the parameter of the previous command.
+ * Only the double byte commands of the sh1106 take a parameter, so the bytes following commands of other controllers, such as the ssd1306 memory mode (0x20) or charge pump (0x8D), are executed as commands of their own, as the sh1106 does.
+ */
+void sh1106_emulator::m_command(const uint8_t command) {
+
+    /* Parameter of a double byte command */
+    if (m_parameter_command != 0) {
+        switch (m_parameter_command) {
+            case 0x81: m_contrast = command; break;
+            case 0xA8: m_multiplex = command & 0x3F; break;
+            case 0xD3: m_offset = command & 0x3F; break;
+            default: break;  // Dc-dc, timing, pads and voltage settings do not change the image
+        }
+        m_parameter_command = 0;
+        return;
+    }
+
+    /* Single byte commands */
+    if (command <= 0x0F) {
+        m_column = (m_column & 0xF0) | command;
+        m_read_dummy = true;
+    } else if (command <= 0x1F) {
+        m_column = (m_column & 0x0F) | ((command & 0x0F) << 4);
+        m_read_dummy = true;
+    } else if (command >= 0x40 && command <= 0x7F) {
+        m_startline = command & 0x3F;
+    } else if (command == 0xA0 || command == 0xA1) {
+        m_remap = command & 1;
+    } else if (command == 0xA4 || command == 0xA5) {
+        m_entire_on = command & 1;
+    } else if (command == 0xA6 || command == 0xA7) {
+        m_inverted = command & 1;
+    } else if (command == 0xAE || command == 0xAF) {
+        m_on = command & 1;
+    } else if (command >= 0xB0 && command <= 0xB7) {
+        m_page = command & 0x07;
+        m_read_dummy = true;
+    } else if (command == 0xC0 || command == 0xC8) {
+        m_scan_decreasing = (command == 0xC8);
+    } else if (command == 0xE0) {
+        m_rmw = true;
+        m_rmw_column = m_column;
+    } else if (command == 0xEE) {
+        m_rmw = false;
+        m_column = m_rmw_column;
+    } else if (command >= 0x30 && command <= 0x33) {
+        // Pump voltage, does not change the image
+    } else if (command == 0x81 || command == 0xA8 || command == 0xAD || command == 0xD3 || command == 0xD5 || command == 0xD9 || command == 0xDA || command == 0xDB) {
+        m_parameter_command = command;
+    }
+}
+
+/**
+ * Writes a byte of display data at the current address.
+ */
+void sh1106_emulator::m_data(const uint8_t data) {
+    if (m_page < 8 && m_column < 132) {
+        m_gdram[m_page][m_column] = data;
+    }
+    m_column++;
+}
@@ -0,0 +1,51 @@
+#ifndef SH1106_EMULATOR_H
+#define SH1106_EMULATOR_H
+
+/* Project libraries */
+#include "sh1106_transport.h"
+
+/**
+ * Model of the controller, rebuilding its gdram from the exact stream of commands and data it receives.
+ * It can be plugged into sh1106::setup() as a transport, or be given the i2c transactions captured on a bus, so that what ends up on the panel can be compared against golden images.
+ */
+class sh1106_emulator : public sh1106_transport {
+
+   public:
+    sh1106_emulator(const int width = 128, const int height = 64, const int column_offset = 2) : m_width(width), m_height(height), m_column_offset(column_offset) {}
+    void reset(void);
+
+    /* Input */
+    int write(const bool dc, const uint8_t* const bytes, const size_t length);
+    int i2c_receive(const uint8_t* const bytes, const size_t length);
+    void i2c_request(uint8_t* const bytes, const size_t length);
+
+    /* Output */
+    uint8_t gdram_get(const size_t page, const size_t column) const;
+    bool pixel_get(const int x, const int y) const;
+    size_t pbm_export(uint8_t* const pbm, const size_t size) const;
+    int pbm_compare(const uint8_t* const pbm, const size_t length, size_t* const mismatches = NULL) const;
+
+   protected:
+    const int m_width, m_height;  //!< Size of the panel.
+    const int m_column_offset;    //!< First gdram column visible on the panel.
+    uint8_t m_gdram[8][132] = {};
+    size_t m_page = 0;
+    size_t m_column = 0;
+    bool m_rmw = false;             //!< Whether in read-modify-write mode, where reads do not move the column address.
+    size_t m_rmw_column = 0;        //!< Column address restored when leaving read-modify-write mode.
+    uint8_t m_startline = 0;        //!< First gdram row displayed.
+    uint8_t m_offset = 0;           //!< Vertical display offset.
+    uint8_t m_multiplex = 63;       //!< Number of displayed rows minus one.
+    bool m_remap = false;           //!< Whether the segment remap is set, as sh1106 does.
+    bool m_scan_decreasing = false;  //!< Whether com lines are scanned in decreasing order, as sh1106 does.
+    bool m_inverted = false;
+    bool m_entire_on = false;
+    bool m_on = false;
+    uint8_t m_contrast = 0x80;
+    uint8_t m_parameter_command = 0;  //!< Command waiting for its parameter byte, or 0.
+    bool m_read_dummy = true;         //!< Whether the next read returns the dummy byte that follows an address change.
+    void m_command(const uint8_t command);
+    void m_data(const uint8_t data);
+};
+
+#endif
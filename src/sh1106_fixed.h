@@ -0,0 +1,114 @@
+#ifndef SH1106_FIXED_H
+#define SH1106_FIXED_H
+
+/* Project libraries */
+#include "sh1106.h"
+
+/**
+ * Variant of the driver for a panel whose size, and optionally rotation, are known at compile time.
+ * The local buffer is a member of the class, and pixels are addressed with constants, which turns the per pixel address math into shifts and masks.
+ * @tparam W The width of the panel.
+ * @tparam H The height of the panel.
+ * @tparam R The rotation, from 0 to 3, or -1 to keep it changeable with setRotation().
+ */
+template <int W, int H, int R = -1>
+class sh1106_fixed : public sh1106 {
+    static_assert(W > 0 && W <= 132 && H > 0 && H <= 64, "Panel size not supported by the controller");
+    static_assert(R >= -1 && R <= 3, "Rotation should be from 0 to 3, or -1");
+
+   public:
+    static const int PAGES = (H + 7) / 8;
+
+    sh1106_fixed(void) : sh1106(W, H) {
+        if (R >= 0) {
+            sh1106::setRotation(R);
+        }
+    }
+
+    /* Setup, with the buffer held by the class, the i2c one being buffered instead of light */
+    using sh1106::setup;
+    int setup(TwoWire& i2c_library, const uint8_t i2c_address, const int pin_res) {
+        return sh1106::setup(i2c_library, i2c_address, pin_res, m_frame);
+    }
+    int setup(SPIClass& spi_library, const int spi_speed, const int pin_cs, const int pin_dc, const int pin_res) {
+        return sh1106::setup(spi_library, spi_speed, pin_cs, pin_dc, pin_res, m_frame);
+    }
+#if SH1106_SPI_3WIRES_GROUPS > 0
+    int setup(SPIClass& spi_library, const int spi_speed, const int pin_cs, const int pin_res) {
+        return sh1106::setup(spi_library, spi_speed, pin_cs, pin_res, m_frame);
+    }
+#endif
+    int setup(sh1106_transport& transport, const int pin_res) {
+        return sh1106::setup(transport, pin_res, m_frame);
+    }
+
+    /* With a fixed rotation, it can not be changed */
+    void setRotation(uint8_t r) {
+        if (R < 0) {
+            sh1106::setRotation(r);
+        }
+    }
+
+    void drawPixel(int16_t x, int16_t y, uint16_t color) {
+
+        /* Go through the generic path when the buffer does not hold the whole panel, or in grayscale mode */
+        if (m_buffer == NULL || m_buffer_pages != PAGES || m_grayscale != NULL) {
+            sh1106::drawPixel(x, y, color);
+            return;
+        }
+
+        /* Handle rotation, with constant bounds */
+        uint16_t x_panel, y_panel;
+        switch ((R >= 0) ? R : rotation) {
+            case 0: {
+                if ((uint16_t)x >= W || (uint16_t)y >= H) return;
+                x_panel = x;
+                y_panel = y;
+                break;
+            }
+            case 1: {
+                if ((uint16_t)x >= H || (uint16_t)y >= W) return;
+                x_panel = W - 1 - y;
+                y_panel = x;
+                break;
+            }
+            case 2: {
+                if ((uint16_t)x >= W || (uint16_t)y >= H) return;
+                x_panel = W - 1 - x;
+                y_panel = H - 1 - y;
+                break;
+            }
+            default: {
+                if ((uint16_t)x >= H || (uint16_t)y >= W) return;
+                x_panel = y;
+                y_panel = H - 1 - x;
+                break;
+            }
+        }
+
+        /* Modify local buffer */
+        const uint8_t page = y_panel >> 3;
+        uint8_t& destination = m_buffer[page * W + x_panel];
+        if (color) {
+            destination |= 1 << (y_panel & 7);
+        } else {
+            destination &= ~(1 << (y_panel & 7));
+        }
+        if (x_panel < m_dirty_min[page]) m_dirty_min[page] = x_panel;
+        if (x_panel > m_dirty_max[page]) m_dirty_max[page] = x_panel;
+    }
+
+    void fillScreen(uint16_t color) {
+        if (m_buffer == NULL || m_buffer_pages != PAGES || m_grayscale != NULL) {
+            sh1106::fillScreen(color);
+            return;
+        }
+        memset(m_buffer, color ? 0xFF : 0x00, W * PAGES);
+        m_dirty_mark_all();
+    }
+
+   protected:
+    uint8_t m_frame[W * PAGES] = {};  //!< Local buffer.
+};
+
+#endif
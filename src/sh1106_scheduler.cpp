@@ -0,0 +1,168 @@
+/* Self header */
+#include "sh1106_scheduler.h"
+
+/**
+ * Registers a panel with the scheduler. Its transfers should then only be carried out through submit() and poll().
+ * @param[in] panel The panel, already set up.
+ * @param[in] priority The priority of the panel, higher is served first.
+ * @return 0 in case of success, or a negative error code otherwise.
+ */
+int sh1106_scheduler::panel_add(sh1106& panel, const uint8_t priority) {
+    if (m_slot_find(panel) != NULL) {
+        return -EINVAL;
+    }
+    for (size_t i = 0; i < SH1106_SCHEDULER_PANELS; i++) {
+        if (m_slots[i].panel == NULL) {
+            m_slots[i] = {};
+            m_slots[i].panel = &panel;
+            m_slots[i].priority = priority;
+            return 0;
+        }
+    }
+    return -ENOMEM;
+}
+
+/**
+ * Unregisters a panel, completing its transfer if one is in progress.
+ * @param[in] panel The panel.
+ * @return 0 in case of success, or a negative error code otherwise.
+ */
+int sh1106_scheduler::panel_remove(sh1106& panel) {
+    int res = 0;
+    struct slot* slot = m_slot_find(panel);
+    if (slot == NULL) {
+        return -EINVAL;
+    }
+    if (slot->pending) {
+        while ((res = panel.display_poll()) > 0) {
+        }
+    }
+    slot->panel = NULL;
+    return res;
+}
+
+/**
+ * Changes the priority of a panel.
+ * @param[in] panel The panel.
+ * @param[in] priority The priority of the panel, higher is served first.
+ * @return 0 in case of success, or a negative error code otherwise.
+ */
+int sh1106_scheduler::priority_set(sh1106& panel, const uint8_t priority) {
+    struct slot* slot = m_slot_find(panel);
+    if (slot == NULL) {
+        return -EINVAL;
+    }
+    slot->priority = priority;
+    return 0;
+}
+
+/**
+ * Requests the parts of the local buffer of a panel that changed to be sent, as poll() gets called.
+ * If the panel already has a transfer in progress, another one follows it so that the latest changes are sent too.
+ * @param[in] panel The panel.
+ * @param[in] deadline An optional time, as returned by micros(), by which the transfer should be complete. Panels with a deadline are served before the others, earliest first.
+ * @return 0 in case of success, or a negative error code otherwise.
+ */
+int sh1106_scheduler::submit(sh1106& panel, const uint32_t deadline) {
+    struct slot* slot = m_slot_find(panel);
+    if (slot == NULL) {
+        return -EINVAL;
+    }
+    if (deadline != 0 && (!slot->deadline_set || (int32_t)(deadline - slot->deadline) < 0)) {
+        slot->deadline_set = true;
+        slot->deadline = deadline;
+    }
+    if (slot->pending) {
+        slot->resubmit = true;
+        return 0;
+    }
+    int res = panel.display_begin();
+    if (res < 0) {
+        return res;
+    }
+    slot->pending = true;
+    slot->age = 0;
+    return 0;
+}
+
+/**
+ * Sends the next chunk on the bus, for the panel that needs it most.
+ * @return The number of panels that still have a transfer in progress, or a negative error code otherwise.
+ */
+int sh1106_scheduler::poll(void) {
+    int res;
+
+    /* Elect a panel */
+    struct slot* elected = NULL;
+    for (size_t i = 0; i < SH1106_SCHEDULER_PANELS; i++) {
+        struct slot* slot = &m_slots[i];
+        if (slot->panel == NULL || !slot->pending) {
+            continue;
+        }
+        if (elected == NULL) {
+            elected = slot;
+        } else if (slot->deadline_set != elected->deadline_set) {
+            if (slot->deadline_set) elected = slot;
+        } else if (slot->deadline_set) {
+            if ((int32_t)(slot->deadline - elected->deadline) < 0) elected = slot;
+        } else if (slot->priority + slot->age > elected->priority + elected->age) {
+            elected = slot;
+        }
+    }
+    if (elected == NULL) {
+        return 0;
+    }
+
+    /* Send one chunk of its transfer, and let the others age */
+    res = elected->panel->display_poll();
+    for (size_t i = 0; i < SH1106_SCHEDULER_PANELS; i++) {
+        if (&m_slots[i] != elected && m_slots[i].pending && m_slots[i].age < 0xFFFF) {
+            m_slots[i].age++;
+        }
+    }
+    elected->age = 0;
+    if (res <= 0) {
+        elected->pending = false;
+        elected->deadline_set = false;
+        if (res == 0 && elected->resubmit) {
+            elected->resubmit = false;
+            res = elected->panel->display_begin();
+            elected->pending = (res == 0);
+        }
+        if (res < 0) {
+            return res;
+        }
+    }
+
+    /* Return number of panels still pending */
+    int pending = 0;
+    for (size_t i = 0; i < SH1106_SCHEDULER_PANELS; i++) {
+        if (m_slots[i].panel != NULL && m_slots[i].pending) {
+            pending++;
+        }
+    }
+    return pending;
+}
+
+/**
+ * Carries out all the transfers in progress.
+ * @return 0 in case of success, or a negative error code otherwise.
+ */
+int sh1106_scheduler::flush(void) {
+    int res;
+    while ((res = poll()) > 0) {
+    }
+    return res;
+}
+
+/**
+ * Retrieves the slot of a registered panel.
+ */
+struct sh1106_scheduler::slot* sh1106_scheduler::m_slot_find(const sh1106& panel) {
+    for (size_t i = 0; i < SH1106_SCHEDULER_PANELS; i++) {
+        if (m_slots[i].panel == &panel) {
+            return &m_slots[i];
+        }
+    }
+    return NULL;
+}
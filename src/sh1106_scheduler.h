@@ -0,0 +1,39 @@
+#ifndef SH1106_SCHEDULER_H
+#define SH1106_SCHEDULER_H
+
+/* Project libraries */
+#include "sh1106.h"
+
+/* Maximum number of panels a scheduler can handle */
+#ifndef SH1106_SCHEDULER_PANELS
+#define SH1106_SCHEDULER_PANELS 4
+#endif
+
+/**
+ * Shares a bus between several panels, interleaving their transfers one chunk at a time.
+ * The next chunk always goes to the pending panel with the earliest deadline, or otherwise the highest priority, where panels gain priority for each chunk they wait so that none of them can be starved.
+ */
+class sh1106_scheduler {
+
+   public:
+    int panel_add(sh1106& panel, const uint8_t priority = 0);
+    int panel_remove(sh1106& panel);
+    int priority_set(sh1106& panel, const uint8_t priority);
+    int submit(sh1106& panel, const uint32_t deadline = 0);
+    int poll(void);
+    int flush(void);
+
+   protected:
+    struct slot {
+        sh1106* panel;      //!< Registered panel, or NULL if the slot is free.
+        uint8_t priority;   //!< Priority given by the application, higher is served first.
+        uint16_t age;       //!< Number of chunks sent to other panels while this one was pending.
+        bool pending;       //!< Whether the panel has a transfer in progress.
+        bool resubmit;      //!< Whether the panel changed again during its transfer and needs another one.
+        bool deadline_set;  //!< Whether the transfer has a deadline.
+        uint32_t deadline;  //!< Time in microseconds by which the transfer should be complete.
+    } m_slots[SH1106_SCHEDULER_PANELS] = {};
+    struct slot* m_slot_find(const sh1106& panel);
+};
+
+#endif
@@ -0,0 +1,37 @@
+#ifndef SH1106_TRANSPORT_H
+#define SH1106_TRANSPORT_H
+
+/* C/C++ libraries */
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * Interface through which a panel can be driven instead of the wire or spi libraries, for example a dma driven bus, a bus shared with an rtos, or a model of the controller running on a computer.
+ * It receives the same stream of commands and data as a 4-wires spi bus would, and is used by sh1106::setup() in buffered mode.
+ */
+class sh1106_transport {
+
+   public:
+    virtual ~sh1106_transport() {}
+
+    /**
+     * Called before a sequence of consecutive writes, like asserting the chip select of a spi bus. Windows are not nested.
+     */
+    virtual void window_open(void) {}
+
+    /**
+     * Called after a sequence of consecutive writes, like releasing the chip select of a spi bus.
+     */
+    virtual void window_close(void) {}
+
+    /**
+     * Sends bytes to the controller.
+     * @param[in] dc false for commands, true for display data.
+     * @param[in] bytes The bytes to send, or NULL to send zeros.
+     * @param[in] length The number of bytes to send.
+     * @return 0 in case of success, or a negative error code otherwise, which is passed on to the caller of sh1106.
+     */
+    virtual int write(const bool dc, const uint8_t* const bytes, const size_t length) = 0;
+};
+
+#endif